@@ -32,7 +32,7 @@ import m5
 from m5.objects import *
 from m5.defines import buildEnv
 from m5.util import addToPath
-import os, optparse, sys
+import fcntl, json, os, optparse, sys
 
 addToPath('../')
 
@@ -84,6 +84,90 @@ parser.add_option("--inj-vnet", type="int", default=-1,
 parser.add_option("--sim-type", type="int", default=1,
                   help="to run the garnet simulation in default mode\
                   or run it in warm-up -- cool-down mode.")
+parser.add_option("--warmup-cycles", type="int", default=0,
+                  help="Cycles of injection before the measurement window")
+parser.add_option("--measure-cycles", type="int", default=0,
+                  help="Only packets injected in this window after the\
+                        warm-up are measured. Injection then stops and the\
+                        run ends when they have drained (garnet2.0 only).\
+                        Set to 0 to disable.")
+parser.add_option("--drain-cycles", type="int", default=100000,
+                  help="Max cycles to wait for the measured packets")
+parser.add_option("--injection-process", type="choice",
+                  default="bernoulli",
+                  choices=['bernoulli', 'mmpp', 'pareto', 'batch'],
+                  help="Per-node arrival process; the bursty ones use\
+                        --injectionrate as their ON (or mean) rate")
+parser.add_option("--burst-seed", type="int", default=1,
+                  help="Seed of the per-node burst generators")
+# per-node lists: "a,b,c" gives node 0 a, node 1 b, every other node c
+parser.add_option("--burst-mean-on", type="string", default="100",
+                  help="mmpp/pareto: mean ON cycles, per node")
+parser.add_option("--burst-mean-off", type="string", default="100",
+                  help="mmpp/pareto: mean OFF cycles, per node")
+parser.add_option("--burst-off-rate", type="string", default="0",
+                  help="mmpp: OFF state injection rate, per node")
+parser.add_option("--burst-alpha", type="string", default="1.5",
+                  help="pareto: period length shape (> 1), per node")
+parser.add_option("--burst-batch-size", type="string", default="4",
+                  help="batch: mean packets per batch, per node")
+parser.add_option("--trace-file", type="string", default="",
+                  help="Replay this injection trace (built with\
+                        util/garnet_trace_pack.py) instead of the\
+                        synthetic traffic pattern")
+parser.add_option("--checkpoint-at", type="int", default=0,
+                  help="Run for this many cycles, then save the network\
+                        state, in-flight flits included, to\
+                        --checkpoint-dir and exit")
+parser.add_option("--checkpoint-dir", type="string", default="",
+                  help="Directory for --checkpoint-at (default: garnet.cpt\
+                        in the output directory)")
+parser.add_option("--restore-from", type="string", default="",
+                  help="Start from a checkpoint taken with\
+                        --checkpoint-at. The swap options (and injection\
+                        settings) may differ from the checkpointed run,\
+                        the topology and VCs may not.")
+
+parser.add_option("--sweep", action="store_true", default=False,
+                  help="Search for the saturation injection rate in a\
+                        single simulation instead of running one rate.\
+                        Prints the latency/throughput curve.")
+parser.add_option("--sweep-warmup-cycles", type="int", default=1000,
+                  help="Cycles to run at each rate before measuring")
+parser.add_option("--sweep-measure-cycles", type="int", default=10000,
+                  help="Cycles over which each rate is measured")
+parser.add_option("--sweep-drain-cycles", type="int", default=100000,
+                  help="Max cycles to wait for the network to empty\
+                        before a rate, and for its measured packets to\
+                        drain after it")
+parser.add_option("--sweep-min-rate", type="float", default=0.02,
+                  help="Rate at which zero-load latency is measured")
+parser.add_option("--sweep-step", type="float", default=0.02,
+                  help="Initial rate step; doubled after every rate\
+                        below saturation")
+parser.add_option("--sweep-latency-multiple", type="float", default=3.0,
+                  help="The network is saturated once latency exceeds\
+                        this multiple of zero-load latency")
+
+parser.add_option("--batch", type="string", default="",
+                  help="Run every parameter point listed in this file on\
+                        one network: one point per line, as key=value\
+                        pairs out of injectionrate, synthetic,\
+                        whenToSwap, occupancy_swap and\
+                        swap_stall_threshold. Unset keys take the command\
+                        line value. Routing and VCs are fixed per run.")
+parser.add_option("--batch-output", type="string", default="batch.jsonl",
+                  help="File the --batch results are appended to, one\
+                        JSON record per point (relative to the output\
+                        directory). Appends are locked, so runs may share\
+                        a file.")
+parser.add_option("--batch-warmup-cycles", type="int", default=1000,
+                  help="Cycles to run each batch point before measuring")
+parser.add_option("--batch-measure-cycles", type="int", default=10000,
+                  help="Cycles over which each batch point is measured")
+parser.add_option("--batch-drain-cycles", type="int", default=100000,
+                  help="Max cycles to wait for the packets measured at\
+                        a batch point to drain")
 
 #
 # Add the ruby specific and protocol specific options
@@ -100,11 +184,88 @@ if args:
      sys.exit(1)
 
 
+if options.measure_cycles > 0 and options.network != "garnet2.0":
+    print("Error: --measure-cycles needs --network=garnet2.0")
+    sys.exit(1)
+
+if options.measure_cycles > 0 and options.sweep:
+    print("Error: --sweep runs its own warm-up and measurement phases")
+    sys.exit(1)
+
+if options.trace_file and options.sweep:
+    print("Error: --sweep varies the synthetic rate, not a trace")
+    sys.exit(1)
+
+if (options.checkpoint_at > 0 or options.restore_from) and \
+   options.network != "garnet2.0":
+    print("Error: network checkpoints need --network=garnet2.0")
+    sys.exit(1)
+
+if options.checkpoint_at > 0 and options.sweep:
+    print("Error: --sweep cannot be combined with --checkpoint-at")
+    sys.exit(1)
+
+# the testers' sent packet counts are not checkpointed, so a restored
+# network could not be told apart from one that has drained
+if options.restore_from and (options.sweep or options.batch):
+    print("Error: --sweep and --batch cannot start from --restore-from")
+    sys.exit(1)
+
+# key=value pairs accepted in a --batch file, with their types
+batch_knobs = {
+    'injectionrate': float,
+    'synthetic': str,
+    'whenToSwap': int,
+    'occupancy_swap': int,
+    'swap_stall_threshold': int,
+}
+
+def read_batch(path):
+    points = []
+    with open(path) as f:
+        for lineno, line in enumerate(f, 1):
+            line = line.split('#', 1)[0].strip()
+            if not line:
+                continue
+            point = {}
+            for field in line.split():
+                key, sep, value = field.partition('=')
+                try:
+                    point[key] = batch_knobs[key](value)
+                except (KeyError, ValueError):
+                    print("Error: %s:%d: bad batch field '%s'"
+                          % (path, lineno, field))
+                    sys.exit(1)
+            if point.get('synthetic', options.synthetic) not in \
+               parser.get_option("--synthetic").choices:
+                print("Error: %s:%d: unknown synthetic traffic '%s'"
+                      % (path, lineno, point['synthetic']))
+                sys.exit(1)
+            if 'whenToSwap' in point and not options.interswap:
+                print("Error: %s:%d: whenToSwap needs --interswap"
+                      % (path, lineno))
+                sys.exit(1)
+            points.append(point)
+    return points
+
+if options.batch:
+    if options.network != "garnet2.0":
+        print("Error: --batch needs --network=garnet2.0")
+        sys.exit(1)
+    if options.sweep or options.measure_cycles > 0 or \
+       options.checkpoint_at > 0 or options.trace_file:
+        print("Error: --batch runs its own warm-up and measurement "
+              "phases of synthetic traffic")
+        sys.exit(1)
+    batch_points = read_batch(options.batch)
+
 if options.inj_vnet > 2:
     print("Error: Injection vnet %d should be 0 (1-flit), 1 (1-flit) "
           "or 2 (5-flit) or -1 (random)" % (options.inj_vnet))
     sys.exit(1)
 
+def per_node(values):
+    return [float(v) for v in values.split(",")]
 
 cpus = [ GarnetSyntheticTraffic(
                      num_packets_max=options.num_packets_max,
@@ -115,6 +276,21 @@ cpus = [ GarnetSyntheticTraffic(
                      inj_rate=options.injectionrate,
                      inj_vnet=options.inj_vnet,
                      precision=options.precision,
+                     sim_type=2 if options.sweep or options.batch or \
+                                   options.measure_cycles \
+                              else options.sim_type,
+                     warmup_cycles=options.warmup_cycles,
+                     measure_cycles=options.measure_cycles,
+                     drain_cycles=options.drain_cycles,
+                     trace_file=options.trace_file,
+                     injection_process=options.injection_process,
+                     random_seed=options.garnet_seed,
+                     burst_seed=options.burst_seed,
+                     burst_mean_on=per_node(options.burst_mean_on),
+                     burst_mean_off=per_node(options.burst_mean_off),
+                     burst_off_rate=per_node(options.burst_off_rate),
+                     burst_alpha=per_node(options.burst_alpha),
+                     burst_batch_size=per_node(options.burst_batch_size),
                      num_dest=options.num_dirs) \
          for i in range(options.num_cpus) ]
 
@@ -130,6 +306,10 @@ system.clk_domain = SrcClockDomain(clock = options.sys_clock,
 
 Ruby.create_system(options, False, system)
 
+if options.measure_cycles > 0:
+    system.ruby.network.warmup_cycles = options.warmup_cycles
+    system.ruby.network.measure_cycles = options.measure_cycles
+
 # Create a seperate clock domain for Ruby
 system.ruby.clk_domain = SrcClockDomain(clock = options.ruby_clock,
                                         voltage_domain = system.voltage_domain)
@@ -140,6 +320,9 @@ for ruby_port in system.ruby._cpu_ports:
      # Tie the cpu test ports to the ruby cpu port
      #
      cpus[i].test = ruby_port.slave
+     # a tester runs in the partition of the controller it drives
+     if options.garnet_partitions > 1:
+         cpus[i].eventq_index = ruby_port._parent.eventq_index
      i += 1
 
 # -----------------------
@@ -153,9 +336,215 @@ root.system.mem_mode = 'timing'
 m5.ticks.setGlobalFrequency('1ns')
 
 # instantiate configuration
-m5.instantiate()
+m5.instantiate(options.restore_from or None)
 
-# simulate until program terminates
-exit_event = m5.simulate(options.abs_max_tick)
+# -----------------------
+# saturation sweep
+# -----------------------
+# One rate at a time: stop injecting until every packet sent so far
+# has been received, then run the rate through a measurement window
+# of the network, as --warmup-cycles/--measure-cycles do: packets
+# created during the warm-up are not measured, injection stops when
+# the window closes and the point ends once the packets created in it
+# have drained. Latency is that of the window's packets, throughput
+# the packets ejected during the window. Rates grow by a doubling
+# step until latency crosses the threshold, then the last two rates
+# are bisected down to the injection precision.
+
+def sweep_drain(network):
+    ticks = 0
+    while ticks < options.sweep_drain_cycles:
+        sent = sum(cpu.getCCObject().getNumPacketsSent() for cpu in cpus)
+        if network.getTotalPacketsReceived() >= sent:
+            return True
+        m5.simulate(100)
+        ticks += 100
+    return False
+
+# Runs one point through a measurement window at the injection rate the
+# testers are set to. Returns (latency, throughput, drained); the
+# latency is None when no measured packet arrived.
+def measure_window(network, warmup, measure, drain):
+    network.setMeasurementWindow(warmup, measure)
+    m5.stats.reset()
+    m5.simulate(warmup)
+    start = network.getTotalPacketsReceived()
+    exit_event = m5.simulate(measure)
+    accepted = network.getTotalPacketsReceived() - start
+
+    for cpu in cpus:
+        cpu.getCCObject().setInjRate(0.0)
+    if exit_event.getCause() != "all measured packets drained":
+        exit_event = m5.simulate(drain)
+    drained = (exit_event.getCause() == "all measured packets drained")
+
+    received = network.getPacketsReceived()
+    latency = network.getAvgPacketLatency() if received else None
+    throughput = float(accepted) / (measure * len(cpus))
+    return (latency, throughput, drained)
+
+def sweep_measure(network, rate):
+    for cpu in cpus:
+        cpu.getCCObject().setInjRate(0.0)
+    if not sweep_drain(network):
+        print("warning: network did not drain in %d cycles before rate %f"
+              % (options.sweep_drain_cycles, rate))
+
+    for cpu in cpus:
+        cpu.getCCObject().setInjRate(rate)
+    (latency, throughput, drained) = \
+        measure_window(network, options.sweep_warmup_cycles,
+                       options.sweep_measure_cycles,
+                       options.sweep_drain_cycles)
+    # packets still stuck in the network count as saturation
+    if latency is None or not drained:
+        latency = float('inf')
+
+    print("sweep: rate %f latency %f throughput %f"
+          % (rate, latency, throughput))
+    return (rate, latency, throughput)
+
+def run_sweep():
+    network = system.ruby.network.getCCObject()
+    resolution = pow(10.0, -options.precision)
+
+    curve = [ sweep_measure(network, options.sweep_min_rate) ]
+    threshold = curve[0][1] * options.sweep_latency_multiple
+
+    # coarse search: lo is the highest rate known to be below saturation
+    lo = options.sweep_min_rate
+    hi = None
+    step = options.sweep_step
+    while hi is None and lo < 1.0:
+        point = sweep_measure(network, min(lo + step, 1.0))
+        curve.append(point)
+        if point[1] > threshold:
+            hi = point[0]
+        else:
+            lo = point[0]
+            step *= 2
+
+    # bisection between the last good and the first saturated rate
+    while hi is not None and hi - lo > resolution:
+        mid = round((lo + hi) / 2, options.precision)
+        if mid <= lo or mid >= hi:
+            break
+        point = sweep_measure(network, mid)
+        curve.append(point)
+        if point[1] > threshold:
+            hi = mid
+        else:
+            lo = mid
+
+    curve.sort()
+    with open(os.path.join(m5.options.outdir, 'sat_sweep.txt'), 'w') as f:
+        f.write("# zero_load_latency %f threshold %f\n"
+                % (curve[0][1], threshold))
+        f.write("# rate latency throughput\n")
+        for (rate, latency, throughput) in curve:
+            f.write("%f %f %f\n" % (rate, latency, throughput))
+        f.write("saturation_rate %f\n" % lo)
+
+    print("Saturation injection rate:", lo,
+          "(zero-load latency %f)" % curve[0][1])
 
-print('Exiting @ tick', m5.curTick(), 'because', exit_event.getCause())
+# -----------------------
+# batch of parameter points
+# -----------------------
+# The network is elaborated once. Each point stops injection, resets
+# the network to its post-init state (protocol messages still queued
+# at the NIs are dropped with it), applies the point's knobs, then runs
+# the point through a measurement window and drain as in the sweep.
+# One JSON record per point is appended to the output under an
+# exclusive lock, so that concurrent runs (one per routing algorithm
+# and VC count) can share the file.
+
+def write_batch_record(path, record):
+    with open(path, 'a') as f:
+        fcntl.flock(f, fcntl.LOCK_EX)
+        f.write(json.dumps(record, sort_keys=True) + "\n")
+        f.flush()
+        fcntl.flock(f, fcntl.LOCK_UN)
+
+def run_batch(points):
+    network = system.ruby.network.getCCObject()
+    testers = [ cpu.getCCObject() for cpu in cpus ]
+    out_path = os.path.join(m5.options.outdir, options.batch_output)
+    defaults = { 'injectionrate': options.injectionrate,
+                 'synthetic': options.synthetic,
+                 'whenToSwap': options.whenToSwap,
+                 'occupancy_swap': options.occupancy_swap,
+                 'swap_stall_threshold': options.swap_stall_threshold }
+    # whenToSwap only applies with --interswap; 0 keeps the current one
+    when_to_swap = options.whenToSwap if options.interswap else 0
+
+    for (n, point) in enumerate(points):
+        knobs = dict(defaults)
+        knobs.update(point)
+
+        for tester in testers:
+            tester.setInjRate(0.0)
+        if n > 0:
+            # let the sequencers and controllers hand the last point's
+            # requests to the NIs, where resetNetwork() drops them
+            m5.simulate(10)
+        network.resetNetwork()
+        if options.interswap and knobs['whenToSwap']:
+            network.setWhenToSwap(knobs['whenToSwap'])
+            when_to_swap = knobs['whenToSwap']
+        network.setOccupancySwap(knobs['occupancy_swap'])
+        network.setSwapStallThreshold(knobs['swap_stall_threshold'])
+        for tester in testers:
+            tester.reseed()
+            tester.setTrafficType(knobs['synthetic'])
+            tester.setInjRate(knobs['injectionrate'])
+
+        (latency, throughput, drained) = \
+            measure_window(network, options.batch_warmup_cycles,
+                           options.batch_measure_cycles,
+                           options.batch_drain_cycles)
+        m5.stats.dump()
+        if not drained:
+            print("warning: batch point %d did not drain in %d cycles"
+                  % (n, options.batch_drain_cycles))
+
+        received = network.getPacketsReceived()
+        record = dict(knobs)
+        # the policy that actually ran, not the requested one
+        record['whenToSwap'] = when_to_swap
+        record.update({
+            'point': n,
+            'outdir': m5.options.outdir,
+            'routing_algorithm': options.routing_algorithm,
+            'vcs_per_vnet': options.vcs_per_vnet,
+            'interswap': options.interswap,
+            'tick': m5.curTick(),
+            'packets_received': received,
+            'latency': latency,
+            'throughput': throughput,
+            'drained': drained,
+        })
+        write_batch_record(out_path, record)
+        print("batch: point %d of %d done" % (n + 1, len(points)))
+
+if options.checkpoint_at > 0:
+    exit_event = m5.simulate(options.checkpoint_at)
+    if exit_event.getCause() != "simulate() limit reached":
+        print('Exiting @ tick', m5.curTick(), 'because',
+              exit_event.getCause(), '(no checkpoint taken)')
+        sys.exit(1)
+    cpt_dir = options.checkpoint_dir or \
+              os.path.join(m5.options.outdir, "garnet.cpt")
+    m5.checkpoint(cpt_dir)
+    print('Network checkpoint @ tick', m5.curTick(), 'saved to', cpt_dir)
+elif options.sweep:
+    run_sweep()
+    print('Exiting @ tick', m5.curTick(), 'because sweep completed')
+elif options.batch:
+    run_batch(batch_points)
+    print('Exiting @ tick', m5.curTick(), 'because batch completed')
+else:
+    # simulate until program terminates
+    exit_event = m5.simulate(options.abs_max_tick)
+
+    print('Exiting @ tick', m5.curTick(), 'because', exit_event.getCause())
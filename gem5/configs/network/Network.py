@@ -65,7 +65,25 @@ def define_options(parser):
                       help="""routing algorithm in network.
                             0: weight-based table
                             1: XY (for Mesh. see garnet2.0/RoutingUnit.cc)
-                            2: Custom (see garnet2.0/RoutingUnit.cc""")
+                            2: random, 3: adaptive random,
+                            4: west-first, 5: adaptive west-first (Mesh)
+                            7: Custom (see garnet2.0/RoutingUnit.cc)
+                            8: congestion-aware adaptive (Mesh)""")
+    parser.add_option("--congestion-delay", action="store", type="int",
+                      default=2,
+                      help="""cycles before a neighbour's congestion
+                            estimate, carried on credits, is used by
+                            congestion-aware routing""")
+    parser.add_option("--congestion-local-only", action="store_true",
+                      default=False,
+                      help="""congestion-aware routing selects on local
+                            credits only (DyXY), without the regional
+                            estimate""")
+    parser.add_option("--garnet-seed", action="store", type="int",
+                      default=1,
+                      help="""seed of the per-router random streams of
+                            garnet2.0 (random and adaptive routing) and
+                            of the synthetic traffic testers""")
     parser.add_option("--network-fault-model", action="store_true",
                       default=False,
                       help="""enable network fault model:
@@ -73,6 +91,15 @@ def define_options(parser):
     parser.add_option("--garnet-deadlock-threshold", action="store",
                       type="int", default=500000,
                       help="network-level deadlock threshold.")
+    parser.add_option("--multi-flit", action="store_true",
+                      default=False,
+                      help="""split packets into link-width flits in garnet
+                            instead of sending every packet as one wide
+                            flit""")
+    parser.add_option("--bitmask-sw-alloc", action="store_true",
+                      default=False,
+                      help="""use the bitmask-based switch allocator in
+                            garnet routers (same grants as the default one)""")
 
     parser.add_option("--interswap", action="store",
                         type="int", default=0,
@@ -81,7 +108,9 @@ def define_options(parser):
     parser.add_option("--whenToSwap", action="store", type="int",
                     default=0, help="""when interSwap enabled it decides when
                     should upstream router initiate swap: TDM, 2*TDM,
-                    counter-based, or any other event driven""")
+                    counter-based, or any other event driven.
+                    11: adaptive (on local stall/occupancy, see
+                    --swap-stall-threshold and --occupancy-swap)""")
     parser.add_option("--whichToSwap", action="store", type="int",
                     default=0, help="""when interSwap enabled it decides when
                     should upstream router can also include Local ports to
@@ -94,6 +123,10 @@ def define_options(parser):
     parser.add_option("--no-is-swap", action="store",
                     type="int", default=0,
                     help="when true, is_swap bit is not used.")
+    parser.add_option("--swap-stall-threshold", action="store",
+                    type="int", default=128,
+                    help="cycles the swap_ptr flit must stay blocked " \
+                    "before the router checks for a deadlock symptom")
     parser.add_option("--occupancy-swap", action="store",
                     type="int", default=0,
                     help="initiate swap when occpancy of that input " \
@@ -102,6 +135,23 @@ def define_options(parser):
                     type="int", default=0,
                     help="when set then all packets are injected into the "\
                     "same VNet at the NIC")
+    parser.add_option("--garnet-telemetry-period", action="store",
+                    type="int", default=0,
+                    help="sample per-router occupancy, per-link flits and "\
+                    "swap/bail-out counts every this many cycles into "\
+                    "garnet_telemetry.bin (util/garnet_telemetry.py reads "\
+                    "it); 0 disables")
+    parser.add_option("--garnet-flit-trace", action="store_true",
+                    default=False,
+                    help="write a binary trace of flit lifecycle events to "\
+                    "garnet_flit_trace.bin (util/garnet_flit_trace.py "\
+                    "converts it to Chrome trace JSON)")
+    parser.add_option("--garnet-partitions", action="store", type="int",
+                    default=1,
+                    help="split the routers into this many rectangular "\
+                    "tiles, each simulated on its own event queue and "\
+                    "host thread (the nodes attached to a router run "\
+                    "with it)")
 
 def create_network(options, ruby):
 
@@ -127,6 +177,44 @@ def create_network(options, ruby):
 
     return (network, IntLinkClass, ExtLinkClass, RouterClass, InterfaceClass)
 
+# Tile of each router: the mesh is cut into px x py rectangles (px along
+# the columns), as square as the partition count allows. Without mesh
+# rows the routers are cut into runs of consecutive ids.
+def router_partitions(options, num_routers):
+    parts = options.garnet_partitions
+    if options.mesh_rows <= 0:
+        return [r * parts // num_routers for r in range(num_routers)]
+
+    rows = options.mesh_rows
+    cols = num_routers // rows
+    py = max(d for d in range(1, int(math.sqrt(parts)) + 1)
+             if parts % d == 0)
+    px = parts // py
+    if px > cols or py > rows:
+        fatal("cannot cut a %dx%d mesh into %d partitions" %
+              (rows, cols, parts))
+    return [(r // cols) * py // rows * px + (r % cols) * px // cols
+            for r in range(num_routers)]
+
+# Put every router, and everything that talks to it directly, on the
+# event queue of its partition. GarnetNetwork checks the placement.
+def partition_network(options, network):
+    # router ids are Int params, which cannot index a list
+    part = router_partitions(options, len(network.routers))
+    for router in network.routers:
+        router.eventq_index = part[int(router.router_id)]
+    for (i, link) in enumerate(network.ext_links):
+        # the controller, its sequencer and buffers, the NI and the
+        # links between them all run with the router
+        p = part[int(link.int_node.router_id)]
+        link.eventq_index = p
+        link.ext_node.eventq_index = p
+        network.netifs[i].eventq_index = p
+    for link in network.int_links:
+        # a link is woken by the side that sends on it
+        link.network_link.eventq_index = part[int(link.src_node.router_id)]
+        link.credit_link.eventq_index = part[int(link.dst_node.router_id)]
+
 def init_network(options, network, InterfaceClass):
 
     if options.network == "garnet2.0":
@@ -134,10 +222,18 @@ def init_network(options, network, InterfaceClass):
         network.vcs_per_vnet = options.vcs_per_vnet
         network.ni_flit_size = options.link_width_bits / 8
         network.routing_algorithm = options.routing_algorithm
+        network.congestion_delay = options.congestion_delay
+        network.congestion_regional = not options.congestion_local_only
+        network.random_seed = options.garnet_seed
         network.garnet_deadlock_threshold = options.garnet_deadlock_threshold
         network.no_is_swap = options.no_is_swap
+        network.swap_stall_threshold = options.swap_stall_threshold
         network.occupancy_swap = options.occupancy_swap
         network.inj_single_vnet = options.inj_single_vnet
+        network.bitmask_sw_alloc = options.bitmask_sw_alloc
+        network.multi_flit = options.multi_flit
+        network.telemetry_period = options.garnet_telemetry_period
+        network.flit_trace = options.garnet_flit_trace
 
     if options.network == "simple":
         network.setup_buffers()
@@ -147,6 +243,10 @@ def init_network(options, network, InterfaceClass):
                   for (i,n) in enumerate(network.ext_links)]
         network.netifs = netifs
 
+    if options.garnet_partitions > 1:
+        assert(options.network == "garnet2.0")
+        partition_network(options, network)
+
     if options.network_fault_model:
         assert(options.network == "garnet2.0")
         network.enable_fault_model = True
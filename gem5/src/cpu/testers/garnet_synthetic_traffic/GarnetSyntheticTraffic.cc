@@ -30,6 +30,7 @@
 
 #include "cpu/testers/garnet_synthetic_traffic/GarnetSyntheticTraffic.hh"
 
+#include <algorithm>
 #include <cmath>
 #include <iomanip>
 #include <set>
@@ -52,6 +53,14 @@ using namespace std;
 
 int TESTER_NETWORK=0;
 
+// entry 'id' of a per-node parameter list, or its last entry
+static double
+perNode(const std::vector<double> &values, int id)
+{
+    fatal_if(values.empty(), "per-node burst parameter list is empty\n");
+    return values[std::min(id, (int) values.size() - 1)];
+}
+
 bool
 GarnetSyntheticTraffic::CpuPort::recvTimingResp(PacketPtr pkt)
 {
@@ -89,6 +98,12 @@ GarnetSyntheticTraffic::GarnetSyntheticTraffic(const Params *p)
       singleSender(p->single_sender),
       singleDest(p->single_dest),
       sim_type(p->sim_type),
+      warmupCycles(p->warmup_cycles),
+      measureCycles(p->measure_cycles),
+      drainCycles(p->drain_cycles),
+      traceFile(p->trace_file),
+      trace(NULL),
+      process(NULL),
       trafficType(p->traffic_type),
       injRate(p->inj_rate),
       injVnet(p->inj_vnet),
@@ -109,6 +124,31 @@ GarnetSyntheticTraffic::GarnetSyntheticTraffic(const Params *p)
     id = TESTER_NETWORK++;
     DPRINTF(GarnetSyntheticTraffic,"Config Created: Name = %s , and id = %d\n",
             name(), id);
+
+    // own stream per tester, unrelated to the burst generator of the
+    // same node (see InjectionProcess) even when the seeds are equal
+    randomSeed = p->random_seed ^ (0x85ebca6bu * (uint32_t) (id + 1));
+    m_rng.init(randomSeed);
+
+    if (traceFile != "")
+        trace = new InjectionTrace(traceFile, id);
+
+    InjectionProcessType process_type =
+        InjectionProcess::typeFromString(p->injection_process);
+    if (process_type != BERNOULLI_) {
+        process = new InjectionProcess(process_type, p->burst_seed, id,
+                                       perNode(p->burst_mean_on, id),
+                                       perNode(p->burst_mean_off, id),
+                                       perNode(p->burst_off_rate, id),
+                                       perNode(p->burst_alpha, id),
+                                       perNode(p->burst_batch_size, id));
+    }
+}
+
+GarnetSyntheticTraffic::~GarnetSyntheticTraffic()
+{
+    delete trace;
+    delete process;
 }
 
 BaseMasterPort &
@@ -126,6 +166,30 @@ GarnetSyntheticTraffic::init()
     numPacketsSent = 0;
 }
 
+void
+GarnetSyntheticTraffic::startup()
+{
+    // restored from a (network) checkpoint: carry on injecting from
+    // the checkpoint tick
+    if (tickEvent.when() < curTick())
+        reschedule(tickEvent, clockEdge(), true);
+}
+
+DrainState
+GarnetSyntheticTraffic::drain()
+{
+    if (tickEvent.scheduled())
+        deschedule(tickEvent);
+    return DrainState::Drained;
+}
+
+void
+GarnetSyntheticTraffic::drainResume()
+{
+    if (!tickEvent.scheduled())
+        schedule(tickEvent, clockEdge());
+}
+
 
 void
 GarnetSyntheticTraffic::completeRequest(PacketPtr pkt)
@@ -152,16 +216,33 @@ GarnetSyntheticTraffic::tick()
     // (injection rate's range depends on precision)
     // - generate a random number between 0 and 10^precision
     // - send pkt if this number is < injRate*(10^precision)
+    // A bursty injection process replaces this trial when configured.
     bool sendAllowedThisCycle;
-    double injRange = pow((double) 10, (double) precision);
-    unsigned trySending = random_mt.random<unsigned>(0, (int) injRange);
-    if (trySending < injRate*injRange)
-        sendAllowedThisCycle = true;
-    else
+    if (process) {
+        sendAllowedThisCycle = process->tick(injRate);
+    } else {
+        double injRange = pow((double) 10, (double) precision);
+        unsigned trySending =
+            m_rng.random<unsigned>(0, (int) injRange);
+        if (trySending < injRate*injRange)
+            sendAllowedThisCycle = true;
+        else
+            sendAllowedThisCycle = false;
+    }
+
+    // no injection while draining the measured packets
+    Tick measureEnd = warmupCycles + measureCycles;
+    bool draining =
+        (sim_type == 2 && measureCycles > 0 && curTick() >= measureEnd);
+    if (draining)
         sendAllowedThisCycle = false;
 
-    // always generatePkt unless fixedPkts or singleSender is enabled
-    if (sendAllowedThisCycle) {
+    if (trace) {
+        // the trace decides when and where this node injects
+        if (!draining)
+            replayTrace();
+    } else if (sendAllowedThisCycle) {
+        // always generatePkt unless fixedPkts or singleSender is enabled
         bool senderEnable = true;
 
         if (numPacketsMax >= 0 && numPacketsSent >= numPacketsMax)
@@ -170,8 +251,11 @@ GarnetSyntheticTraffic::tick()
         if (singleSender >= 0 && id != singleSender)
             senderEnable = false;
 
-        if (senderEnable)
+        if (senderEnable) {
             generatePkt();
+            if (process)
+                process->injected();
+        }
     }
 
     // Schedule wakeup
@@ -183,9 +267,12 @@ GarnetSyntheticTraffic::tick()
                 schedule(tickEvent, clockEdge(Cycles(1)));
         }
     } else if(sim_type == 2) {
-        if (!tickEvent.scheduled())
-        schedule(tickEvent, clockEdge(Cycles(1)));
-//        fatal("sim_type: %d is not implemented currently!", sim_type);
+        // The network exits once every packet injected during the
+        // measurement window has been ejected; this is only a bound
+        if (measureCycles > 0 && curTick() >= measureEnd + drainCycles)
+            exitSimLoop("Network Tester drain limit reached");
+        else if (!tickEvent.scheduled())
+            schedule(tickEvent, clockEdge(Cycles(1)));
     } else {
         fatal("unknown 'sim_type: %d' option given", sim_type);
     }
@@ -207,7 +294,7 @@ GarnetSyntheticTraffic::generatePkt()
     {
         destination = singleDest;
     } else if (traffic == UNIFORM_RANDOM_) {
-        destination = random_mt.random<unsigned>(0, num_destinations - 1);
+        destination = m_rng.random<unsigned>(0, num_destinations - 1);
     } else if (traffic == BIT_COMPLEMENT_) {
         dest_x = radix - src_x - 1;
         dest_y = radix - src_y - 1;
@@ -252,6 +339,51 @@ GarnetSyntheticTraffic::generatePkt()
         fatal("Unknown Traffic Type: %s!\n", traffic);
     }
 
+    // Inject in specific Vnet
+    // Vnet 0 and 1 are for control packets (1-flit)
+    // Vnet 2 is for data packets (5-flit)
+    int injReqType = injVnet;
+
+    if (injReqType < 0 || injReqType > 2)
+    {
+        // randomly inject in any vnet
+        injReqType = m_rng.random(0, 2);
+    }
+
+    injectPkt(destination, injReqType);
+}
+
+void
+GarnetSyntheticTraffic::replayTrace()
+{
+    // Inject every record that is due. A packet the port could not
+    // take holds the rest back, so records keep their per-node order
+    // and are late rather than dropped.
+    const InjectionTraceRecord *rec;
+    while (retryPkt == NULL && (rec = trace->peek()) != NULL &&
+           rec->cycle <= curCycle()) {
+        if (numPacketsMax >= 0 && numPacketsSent >= numPacketsMax)
+            return;
+
+        fatal_if(rec->dst >= numDestinations,
+                 "%s: trace destination %d is not a node\n",
+                 name(), rec->dst);
+        fatal_if(rec->vnet > 2,
+                 "%s: trace vnet %d is not one of 0, 1, 2\n",
+                 name(), rec->vnet);
+
+        DPRINTF(GarnetSyntheticTraffic,
+                "Trace record at cycle %d: dest %d vnet %d size %d\n",
+                rec->cycle, rec->dst, rec->vnet, rec->size);
+
+        injectPkt(rec->dst, rec->vnet);
+        trace->next();
+    }
+}
+
+void
+GarnetSyntheticTraffic::injectPkt(unsigned destination, int injReqType)
+{
     // The source of the packets is a cache.
     // The destination of the packets is a directory.
     // The destination bits are embedded in the address after byte-offset.
@@ -268,8 +400,9 @@ GarnetSyntheticTraffic::generatePkt()
     // while responses are "data" packets (typically 72 bytes).
     //
     // Life of a packet from the tester into the network:
-    // (1) This function generatePkt() generates packets of one of the
-    //     following 3 types (randomly) : ReadReq, INST_FETCH, WriteReq
+    // (1) generatePkt() or replayTrace() picks a destination and calls
+    //     this function, which generates packets of one of the following
+    //     3 types (by vnet) : ReadReq, INST_FETCH, WriteReq
     // (2) mem/ruby/system/RubyPort.cc converts these to RubyRequestType_LD,
     //     RubyRequestType_IFETCH, RubyRequestType_ST respectively
     // (3) mem/ruby/system/Sequencer.cc sends these to the cache controllers
@@ -288,17 +421,6 @@ GarnetSyntheticTraffic::generatePkt()
     RequestPtr req = nullptr;
     Request::Flags flags;
 
-    // Inject in specific Vnet
-    // Vnet 0 and 1 are for control packets (1-flit)
-    // Vnet 2 is for data packets (5-flit)
-    int injReqType = injVnet;
-
-    if (injReqType < 0 || injReqType > 2)
-    {
-        // randomly inject in any vnet
-        injReqType = random_mt.random(0, 2);
-    }
-
     if (injReqType == 0) {
         // generate packet for virtual network 0
         requestType = MemCmd::ReadReq;
@@ -332,6 +454,26 @@ GarnetSyntheticTraffic::generatePkt()
     sendPkt(pkt);
 }
 
+void
+GarnetSyntheticTraffic::setTrafficType(const std::string &type)
+{
+    fatal_if(trafficStringToEnum.count(type) == 0,
+             "Unknown Traffic Type: %s!\n", type);
+    trafficType = type;
+    traffic = trafficStringToEnum[type];
+}
+
+void
+GarnetSyntheticTraffic::reseed()
+{
+    m_rng.init(randomSeed);
+    if (process)
+        process->reset();
+    // the first trial is on this cycle, as the first run's was on
+    // cycle 0
+    reschedule(tickEvent, clockEdge(), true);
+}
+
 void
 GarnetSyntheticTraffic::initTrafficType()
 {
@@ -33,7 +33,10 @@
 
 #include <set>
 
+#include "base/random.hh"
 #include "base/statistics.hh"
+#include "cpu/testers/garnet_synthetic_traffic/InjectionProcess.hh"
+#include "cpu/testers/garnet_synthetic_traffic/InjectionTrace.hh"
 #include "mem/mem_object.hh"
 #include "mem/port.hh"
 #include "params/GarnetSyntheticTraffic.hh"
@@ -58,8 +61,15 @@ class GarnetSyntheticTraffic : public MemObject
   public:
     typedef GarnetSyntheticTrafficParams Params;
     GarnetSyntheticTraffic(const Params *p);
+    ~GarnetSyntheticTraffic();
 
     virtual void init();
+    void startup() override;
+
+    // stop injecting while the system drains for a checkpoint; the
+    // flits already in the network are checkpointed with it
+    DrainState drain() override;
+    void drainResume() override;
 
     // main simulation loop (one cycle)
     void tick();
@@ -75,6 +85,17 @@ class GarnetSyntheticTraffic : public MemObject
     inline int
         get_sim_type() { return sim_type;}
 
+    // Used by the saturation sweep in garnet_synth_traffic.py to
+    // change the offered load between phases of one simulation
+    void setInjRate(double rate) { injRate = rate; }
+    int getNumPacketsSent() { return numPacketsSent; }
+    // Used by the batch mode to move to the next parameter point
+    void setTrafficType(const std::string &type);
+    // restart the injection trials, destinations, vnets and the
+    // injection process from their seeds, on the current cycle, so
+    // every batch point sees the same random sequence
+    void reseed();
+
   protected:
     EventFunctionWrapper tickEvent;
 
@@ -126,6 +147,19 @@ class GarnetSyntheticTraffic : public MemObject
     int singleSender;
     int singleDest;
     int sim_type;
+    // sim_type 2: warm-up, measurement and drain phases
+    Tick warmupCycles;
+    Tick measureCycles;
+    Tick drainCycles;
+    // replayed instead of the synthetic pattern when trace_file is set
+    std::string traceFile;
+    InjectionTrace *trace;
+    // NULL for the default Bernoulli injection
+    InjectionProcess *process;
+    // injection trials, destinations and vnets. Not checkpointed, like
+    // the rest of the tester: a restored run restarts it from the seed
+    uint32_t randomSeed;
+    Random m_rng;
 
     std::string trafficType; // string
     TrafficType traffic; // enum from string
@@ -140,6 +174,8 @@ class GarnetSyntheticTraffic : public MemObject
     void completeRequest(PacketPtr pkt);
 
     void generatePkt();
+    void injectPkt(unsigned destination, int vnet);
+    void replayTrace();
     void sendPkt(PacketPtr pkt);
     void initTrafficType();
 
@@ -27,6 +27,7 @@
 # Authors: Tushar Krishna
 
 from MemObject import MemObject
+from m5.SimObject import *
 from m5.params import *
 from m5.proxy import *
 
@@ -34,6 +35,14 @@ class GarnetSyntheticTraffic(MemObject):
     type = 'GarnetSyntheticTraffic'
     cxx_header = \
         "cpu/testers/garnet_synthetic_traffic/GarnetSyntheticTraffic.hh"
+
+    cxx_exports = [
+        PyBindMethod("setInjRate"),
+        PyBindMethod("getNumPacketsSent"),
+        PyBindMethod("setTrafficType"),
+        PyBindMethod("reseed"),
+    ]
+
     block_offset = Param.Int(6, "block offset in bits")
     num_dest = Param.Int(1, "Number of Destinations")
     memory_size = Param.Int(65536, "memory size")
@@ -56,3 +65,33 @@ class GarnetSyntheticTraffic(MemObject):
     test = MasterPort("Port to the memory system to test")
     system = Param.System(Parent.any, "System we belong to")
     sim_type = Param.Int(1, "type of simulation done in garnet")
+    warmup_cycles = Param.UInt64(0, "sim_type 2: cycles of warm-up "\
+                                 "before the measurement window")
+    measure_cycles = Param.UInt64(0, "sim_type 2: length of the "\
+                                  "measurement window; injection stops "\
+                                  "after it. 0 injects forever")
+    drain_cycles = Param.UInt64(100000, "sim_type 2: cycles to wait for "\
+                                "measured packets to drain before exiting")
+    injection_process = Param.String("bernoulli", "bernoulli, mmpp, "\
+                                     "pareto or batch; see "\
+                                     "InjectionProcess.hh")
+    random_seed = Param.UInt32(1, "Seed of the per-node generators of "\
+                               "the injection trials, destinations and "\
+                               "vnets")
+    burst_seed = Param.UInt32(1, "Seed of the per-node generators of the "\
+                              "bursty injection processes")
+    # Per-node burst parameters: entry i is used by node i, the last
+    # entry by every node beyond the end of the list
+    burst_mean_on = VectorParam.Float([100.0], "mmpp/pareto: mean cycles "\
+                                      "in the ON state")
+    burst_mean_off = VectorParam.Float([100.0], "mmpp/pareto: mean "\
+                                       "cycles in the OFF state")
+    burst_off_rate = VectorParam.Float([0.0], "mmpp: injection rate in "\
+                                       "the OFF state")
+    burst_alpha = VectorParam.Float([1.5], "pareto: shape of the ON/OFF "\
+                                    "period lengths, > 1")
+    burst_batch_size = VectorParam.Float([4.0], "batch: mean packets per "\
+                                         "batch")
+    trace_file = Param.String("", "Replay this injection trace (see "\
+                              "util/garnet_trace_pack.py) instead of "\
+                              "generating synthetic traffic")
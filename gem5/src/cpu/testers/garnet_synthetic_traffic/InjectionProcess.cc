@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/testers/garnet_synthetic_traffic/InjectionProcess.hh"
+
+#include <cassert>
+#include <cmath>
+
+#include "base/logging.hh"
+
+InjectionProcess::InjectionProcess(InjectionProcessType type, uint32_t seed,
+                                   int node, double mean_on,
+                                   double mean_off, double off_rate,
+                                   double alpha, double batch_size)
+    : m_type(type), m_seed(seed ^ (0x9e3779b9u * (uint32_t) (node + 1))),
+      m_mean_on(mean_on), m_mean_off(mean_off), m_off_rate(off_rate),
+      m_alpha(alpha), m_batch_size(batch_size), m_on(true), m_left(0),
+      m_backlog(0)
+{
+    fatal_if(type == BERNOULLI_,
+             "the Bernoulli process is built into the tester\n");
+    fatal_if((type == MMPP_ || type == PARETO_) &&
+             (mean_on < 1 || mean_off < 1),
+             "node %d: burst mean_on/mean_off must be >= 1 cycle\n", node);
+    fatal_if(type == PARETO_ && alpha <= 1,
+             "node %d: pareto alpha must be > 1 for a finite mean\n", node);
+    fatal_if(type == BATCH_ && batch_size < 1,
+             "node %d: batch size must be >= 1\n", node);
+
+    reset();
+}
+
+void
+InjectionProcess::reset()
+{
+    m_rng.init(m_seed);
+    m_on = true;
+    m_left = 0;
+    m_backlog = 0;
+
+    // start ON with the stationary probability of being ON, so that
+    // the nodes are not all bursting together at the start of a run
+    if (m_type == MMPP_ || m_type == PARETO_)
+        m_on = uniform() * (m_mean_on + m_mean_off) < m_mean_on;
+    if (m_type == PARETO_)
+        m_left = periodLength(m_on ? m_mean_on : m_mean_off);
+}
+
+InjectionProcessType
+InjectionProcess::typeFromString(const std::string &name)
+{
+    if (name == "bernoulli")
+        return BERNOULLI_;
+    else if (name == "mmpp")
+        return MMPP_;
+    else if (name == "pareto")
+        return PARETO_;
+    else if (name == "batch")
+        return BATCH_;
+
+    fatal("Unknown injection process: %s\n", name);
+}
+
+uint64_t
+InjectionProcess::periodLength(double mean)
+{
+    // Pareto with scale xm = mean * (alpha - 1) / alpha, by inversion
+    double xm = mean * (m_alpha - 1) / m_alpha;
+    double u = 1.0 - uniform(); // (0, 1]
+    double len = xm / pow(u, 1.0 / m_alpha);
+    return (len < 1) ? 1 : (uint64_t) len;
+}
+
+bool
+InjectionProcess::tick(double rate)
+{
+    switch (m_type) {
+      case MMPP_: {
+        bool inject = uniform() < (m_on ? rate : m_off_rate);
+        // leave the state with probability 1/mean each cycle
+        if (uniform() * (m_on ? m_mean_on : m_mean_off) < 1)
+            m_on = !m_on;
+        return inject;
+      }
+      case PARETO_: {
+        bool inject = m_on && uniform() < rate;
+        if (--m_left == 0) {
+            m_on = !m_on;
+            m_left = periodLength(m_on ? m_mean_on : m_mean_off);
+        }
+        return inject;
+      }
+      case BATCH_: {
+        if (uniform() < rate / m_batch_size) {
+            // geometric on {1, 2, ...} with mean batch_size
+            double p = 1.0 / m_batch_size;
+            uint64_t n = 1;
+            if (p < 1)
+                n += (uint64_t) floor(log(1.0 - uniform()) / log(1.0 - p));
+            m_backlog += n;
+        }
+        return m_backlog > 0;
+      }
+      default:
+        panic("unexpected injection process %d\n", m_type);
+    }
+}
+
+void
+InjectionProcess::injected()
+{
+    if (m_type == BATCH_) {
+        assert(m_backlog > 0);
+        m_backlog--;
+    }
+}
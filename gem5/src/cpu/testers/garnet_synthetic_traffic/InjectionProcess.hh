@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPU_GARNET_INJECTION_PROCESS_HH__
+#define __CPU_GARNET_INJECTION_PROCESS_HH__
+
+#include <cstdint>
+#include <string>
+
+#include "base/random.hh"
+
+// Bursty injection processes for GarnetSyntheticTraffic, used in place
+// of its per-cycle Bernoulli trial when injection_process is not
+// "bernoulli". 'rate' is the tester's inj_rate (packets/node/cycle):
+//
+//  mmpp   - two-state Markov-modulated process. The ON state injects
+//           at rate, OFF at off_rate; geometric state lengths with
+//           means mean_on and mean_off cycles.
+//  pareto - on/off process whose ON and OFF lengths are Pareto with
+//           shape alpha and means mean_on/mean_off; ON injects at
+//           rate. 1 < alpha < 2 gives self-similar aggregate traffic.
+//  batch  - batches arrive with probability rate/batch_size per cycle,
+//           each geometric with mean batch_size packets, so the
+//           offered load is still rate. A batch is handed to the
+//           port one packet per cycle; a packet the tester does not
+//           send (see injected()) stays in the batch.
+//
+// Every node draws from its own generator seeded from (seed, node), so
+// a run is repeatable and independent of the other nodes' draws.
+
+enum InjectionProcessType {BERNOULLI_ = 0,
+                           MMPP_ = 1,
+                           PARETO_ = 2,
+                           BATCH_ = 3};
+
+class InjectionProcess
+{
+  public:
+    InjectionProcess(InjectionProcessType type, uint32_t seed, int node,
+                     double mean_on, double mean_off, double off_rate,
+                     double alpha, double batch_size);
+
+    static InjectionProcessType typeFromString(const std::string &name);
+
+    // advance one cycle; true if a packet should be injected
+    bool tick(double rate);
+    // the tester sent the packet tick() asked for
+    void injected();
+    // back to the state after construction: reseeded, fresh period
+    void reset();
+
+  private:
+    double uniform() { return m_rng.random<double>(); }
+    // cycles in the next ON or OFF period
+    uint64_t periodLength(double mean);
+
+    InjectionProcessType m_type;
+    uint32_t m_seed;
+    Random m_rng;
+    double m_mean_on;
+    double m_mean_off;
+    double m_off_rate;
+    double m_alpha;
+    double m_batch_size;
+
+    bool m_on;
+    uint64_t m_left; // cycles left in the current pareto period
+    uint64_t m_backlog; // batch packets not yet injected
+};
+
+#endif // __CPU_GARNET_INJECTION_PROCESS_HH__
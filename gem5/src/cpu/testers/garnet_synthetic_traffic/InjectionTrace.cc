@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/testers/garnet_synthetic_traffic/InjectionTrace.hh"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "base/logging.hh"
+
+InjectionTrace::InjectionTrace(const std::string &path, int node)
+    : m_map(NULL), m_map_size(0), m_cur(NULL), m_end(NULL)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    fatal_if(fd < 0, "Cannot open injection trace %s\n", path);
+
+    struct stat st;
+    fatal_if(fstat(fd, &st) < 0, "Cannot stat injection trace %s\n", path);
+    m_map_size = st.st_size;
+    fatal_if(m_map_size < sizeof(InjectionTraceHeader),
+             "Injection trace %s is too short\n", path);
+
+    m_map = mmap(NULL, m_map_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    fatal_if(m_map == MAP_FAILED, "Cannot map injection trace %s\n", path);
+
+    const InjectionTraceHeader *header =
+        (const InjectionTraceHeader *) m_map;
+    fatal_if(strncmp(header->magic, GARNET_INJECTION_TRACE_MAGIC,
+                     sizeof(header->magic)) != 0,
+             "%s is not an injection trace\n", path);
+    fatal_if(header->version != GARNET_INJECTION_TRACE_VERSION,
+             "Injection trace %s has unsupported version %d\n",
+             path, header->version);
+
+    // bound the header counts by the file size before forming any
+    // pointer from them, so a corrupt header cannot wrap around
+    uint64_t avail = m_map_size - sizeof(InjectionTraceHeader);
+    uint64_t num_index = (uint64_t) header->num_nodes + 1;
+    fatal_if(num_index > avail / sizeof(uint64_t),
+             "Injection trace %s is truncated\n", path);
+    avail -= num_index * sizeof(uint64_t);
+    fatal_if(header->num_records > avail / sizeof(InjectionTraceRecord),
+             "Injection trace %s is truncated\n", path);
+
+    const uint64_t *first_record = (const uint64_t *) (header + 1);
+    const InjectionTraceRecord *records =
+        (const InjectionTraceRecord *) (first_record + num_index);
+
+    // nodes beyond the ones in the trace have nothing to inject
+    if (node >= header->num_nodes) {
+        m_cur = m_end = records;
+        return;
+    }
+
+    fatal_if(first_record[node] > first_record[node + 1] ||
+             first_record[node + 1] > header->num_records,
+             "Injection trace %s has a bad index for node %d\n", path, node);
+    m_cur = records + first_record[node];
+    m_end = records + first_record[node + 1];
+
+    // madvise() wants a page-aligned start
+    uintptr_t page = sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t) m_cur & ~(page - 1);
+    madvise((void *) start, (uintptr_t) m_end - start, MADV_SEQUENTIAL);
+}
+
+InjectionTrace::~InjectionTrace()
+{
+    if (m_map)
+        munmap(m_map, m_map_size);
+}
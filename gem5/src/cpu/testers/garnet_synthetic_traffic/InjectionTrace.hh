@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPU_GARNET_INJECTION_TRACE_HH__
+#define __CPU_GARNET_INJECTION_TRACE_HH__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Recorded network traffic replayed by GarnetSyntheticTraffic when its
+// trace_file param is set (util/garnet_trace_pack.py writes the file).
+//
+// File layout, little-endian:
+//   InjectionTraceHeader
+//   uint64_t first_record[num_nodes + 1]  records of node n are
+//                                         [first_record[n],
+//                                          first_record[n + 1])
+//   InjectionTraceRecord[num_records]     grouped by src, each group
+//                                         sorted by cycle
+//
+// Each tester maps the file and walks only its own group, so the trace
+// is paged in as it is replayed rather than loaded up front.
+
+#define GARNET_INJECTION_TRACE_MAGIC "GNINJTR"
+#define GARNET_INJECTION_TRACE_VERSION 1
+
+struct InjectionTraceHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t num_nodes;
+    uint64_t num_records;
+};
+
+struct InjectionTraceRecord
+{
+    uint64_t cycle;
+    uint32_t src;
+    uint32_t dst;
+    uint32_t vnet;
+    uint32_t size; // bytes in the recorded message
+};
+
+class InjectionTrace
+{
+  public:
+    InjectionTrace(const std::string &path, int node);
+    ~InjectionTrace();
+
+    // next record of this node; NULL once the node's records are done
+    const InjectionTraceRecord *
+    peek() const
+    {
+        return (m_cur != m_end) ? m_cur : NULL;
+    }
+
+    void next() { m_cur++; }
+
+  private:
+    void *m_map;
+    size_t m_map_size;
+    const InjectionTraceRecord *m_cur;
+    const InjectionTraceRecord *m_end;
+};
+
+#endif // __CPU_GARNET_INJECTION_TRACE_HH__
@@ -36,20 +36,61 @@ Consumer::scheduleEvent(Cycles timeDelta)
     scheduleEventAbsolute(em->clockEdge(timeDelta));
 }
 
+Consumer::~Consumer()
+{
+    for (auto evt : m_pending_events) {
+        em->deschedule(evt);
+        delete evt;
+    }
+    for (auto evt : m_free_events) {
+        delete evt;
+    }
+}
+
+bool
+Consumer::alreadyScheduled(Tick time)
+{
+    if (time == m_last_wakeup && time >= em->clockEdge())
+        return true;
+
+    for (auto evt : m_pending_events) {
+        if (evt->when() == time)
+            return true;
+    }
+    return false;
+}
+
 void
 Consumer::scheduleEventAbsolute(Tick evt_time)
 {
-    if (!alreadyScheduled(evt_time)) {
-        // This wakeup is not redundant
-        auto *evt = new EventFunctionWrapper(
-            [this]{ wakeup(); }, "Consumer Event", true);
+    if (alreadyScheduled(evt_time))
+        return;
+
+    // This wakeup is not redundant
+    WakeupEvent *evt;
+    if (m_free_events.empty()) {
+        evt = new WakeupEvent(this);
+    } else {
+        evt = m_free_events.back();
+        m_free_events.pop_back();
+    }
 
-        em->schedule(evt, evt_time);
-        insertScheduledWakeupTime(evt_time);
+    em->schedule(evt, evt_time);
+    m_pending_events.push_back(evt);
+}
+
+void
+Consumer::processWakeup(WakeupEvent *evt)
+{
+    for (int i = 0; i < m_pending_events.size(); i++) {
+        if (m_pending_events[i] == evt) {
+            m_pending_events[i] = m_pending_events.back();
+            m_pending_events.pop_back();
+            break;
+        }
     }
+    m_free_events.push_back(evt);
+    m_last_wakeup = curTick();
 
-    Tick t = em->clockEdge();
-    set<Tick>::iterator bit = m_scheduled_wakeups.begin();
-    set<Tick>::iterator eit = m_scheduled_wakeups.lower_bound(t);
-    m_scheduled_wakeups.erase(bit,eit);
+    wakeup();
 }
@@ -36,7 +36,7 @@
 #define __MEM_RUBY_COMMON_CONSUMER_HH__
 
 #include <iostream>
-#include <set>
+#include <vector>
 
 #include "sim/clocked_object.hh"
 
@@ -44,29 +44,17 @@ class Consumer
 {
   public:
     Consumer(ClockedObject *_em)
-        : em(_em)
+        : em(_em), m_last_wakeup(MaxTick)
     {
     }
 
-    virtual
-    ~Consumer()
-    { }
+    virtual ~Consumer();
 
     virtual void wakeup() = 0;
     virtual void print(std::ostream& out) const = 0;
     virtual void storeEventInfo(int info) {}
 
-    bool
-    alreadyScheduled(Tick time)
-    {
-        return m_scheduled_wakeups.find(time) != m_scheduled_wakeups.end();
-    }
-
-    void
-    insertScheduledWakeupTime(Tick time)
-    {
-        m_scheduled_wakeups.insert(time);
-    }
+    bool alreadyScheduled(Tick time);
 
     void scheduleEventAbsolute(Tick timeAbs);
 
@@ -74,8 +62,35 @@ class Consumer
     void scheduleEvent(Cycles timeDelta);
 
   private:
-    std::set<Tick> m_scheduled_wakeups;
+    // Wakeup events are owned by the consumer and recycled once they
+    // have fired, so scheduling a wakeup does not allocate.
+    class WakeupEvent : public Event
+    {
+      public:
+        WakeupEvent(Consumer *consumer)
+            : m_consumer(consumer)
+        {
+        }
+
+        void process() { m_consumer->processWakeup(this); }
+        const std::string name() const { return "Consumer Event"; }
+        const char *description() const { return "Consumer Event"; }
+
+      private:
+        Consumer *m_consumer;
+    };
+
+    void processWakeup(WakeupEvent *evt);
+
     ClockedObject *em;
+
+    // Events currently scheduled (at most a handful per consumer)
+    std::vector<WakeupEvent *> m_pending_events;
+    // Events that have fired and can be reused
+    std::vector<WakeupEvent *> m_free_events;
+    // Tick of the last wakeup; it still counts as scheduled for
+    // the rest of that tick
+    Tick m_last_wakeup;
 };
 
 inline std::ostream&
@@ -55,6 +55,8 @@ class BasicIntLink(BasicLink):
     dst_node = Param.BasicRouter("Router on dst end")
 
     # only used by Garnet.
+    # One of Local, North, East, South or West (see PortDirection in
+    # RubySlicc_Exports.sm); empty if the topology does not use directions
     src_outport = Param.String("", "Outport direction at src router")
     dst_inport = Param.String("", "Inport direction at dst router")
 
@@ -48,6 +48,16 @@ const int INFINITE_LATENCY = 10000; // Yes, this is a big hack
 // the second m_nodes set of SwitchIDs represent the the output queues
 // of the network.
 
+// Topology files that do not use direction-based routing leave the
+// port directions empty.
+static PortDirection
+stringToPortDirection(const string& dirn)
+{
+    if (dirn.empty())
+        return PortDirection_Unknown;
+    return string_to_PortDirection(dirn);
+}
+
 Topology::Topology(uint32_t num_routers,
                    const vector<BasicExtLink *> &ext_links,
                    const vector<BasicIntLink *> &int_links)
@@ -91,8 +101,12 @@ Topology::Topology(uint32_t num_routers,
         BasicRouter *router_src = int_link->params()->src_node;
         BasicRouter *router_dst = int_link->params()->dst_node;
 
-        PortDirection src_outport = int_link->params()->src_outport;
-        PortDirection dst_inport = int_link->params()->dst_inport;
+        // Directions are passed in from the topology file as strings;
+        // convert them once here so the network only sees the enum.
+        PortDirection src_outport =
+            stringToPortDirection(int_link->params()->src_outport);
+        PortDirection dst_inport =
+            stringToPortDirection(int_link->params()->dst_inport);
 
         // Store the IntLink pointers for later
         m_int_link_vector.push_back(int_link);
@@ -45,6 +45,7 @@
 #include <vector>
 
 #include "mem/protocol/LinkDirection.hh"
+#include "mem/protocol/PortDirection.hh"
 #include "mem/ruby/common/TypeDefines.hh"
 #include "mem/ruby/network/BasicLink.hh"
 
@@ -52,7 +53,6 @@ class NetDest;
 class Network;
 
 typedef std::vector<std::vector<int> > Matrix;
-typedef std::string PortDirection;
 
 struct LinkEntry
 {
@@ -75,8 +75,8 @@ class Topology
 
   private:
     void addLink(SwitchID src, SwitchID dest, BasicLink* link,
-                 PortDirection src_outport_dirn = "",
-                 PortDirection dest_inport_dirn = "");
+                 PortDirection src_outport_dirn = PortDirection_Unknown,
+                 PortDirection dest_inport_dirn = PortDirection_Unknown);
     void makeLink(Network *net, SwitchID src, SwitchID dest,
                   const NetDest& routing_table_entry);
 
@@ -35,6 +35,8 @@
 #define __MEM_RUBY_NETWORK_GARNET_COMMONTYPES_HH__
 #define MY_PRINT 0
 
+#include <type_traits>
+
 #include "mem/ruby/common/NetDest.hh"
 
 // All common enums and typedefs go here
@@ -47,19 +49,22 @@ enum flit_stage {I_, VA_, SA_, ST_, LT_, NUM_FLIT_STAGE_};
 enum link_type { EXT_IN_, EXT_OUT_, INT_, NUM_LINK_TYPES_ };
 enum RoutingAlgorithm { TABLE_ = 0, XY_ = 1, RANDOM_ = 2, ADAPT_RAND_ = 3,
                        WestFirst_ = 4, ADAPT_WestFirst_ = 5,
-                       DEFLECTION_= 6, CUSTOM_ = 7, NUM_ROUTING_ALGORITHM_ };
+                       DEFLECTION_= 6, CUSTOM_ = 7, CONGESTION_ = 8,
+                       NUM_ROUTING_ALGORITHM_ };
 enum when_to_swap { TDM_ = 1, _2_TDM_ = 2, _4_TDM_ = 3, _8_TDM_ = 4,
                     _16_TDM_ =5, _32_TDM_ = 6, _64_TDM_ = 7, _512_TDM_ = 8,
-					_1024_TDM_ = 9, _2048_TDM_ = 10 };
+					_1024_TDM_ = 9, _2048_TDM_ = 10,
+                    // no global slot: swap on local stall/occupancy
+                    ADAPTIVE_ = 11 };
 enum which_to_swap { DISABLE_LOCAL_SWAP_ = 1, ENABLE_LOCAL_SWAP_ = 2 };
 
+// Route header carried in every flit. The NI sends a separate packet
+// to each destination of a message, so one destination NI is enough
+// for table-based and topology-specific routing alike; the header is
+// plain data and is passed around by const reference.
 struct RouteInfo
 {
-    // destination format for table-based routing
     int vnet;
-    NetDest net_dest;
-
-    // src and dest format for topology-specific routing
     int src_ni;
     int src_router;
     int dest_ni;
@@ -67,6 +72,9 @@ struct RouteInfo
     int hops_traversed;
 };
 
+static_assert(std::is_trivially_copyable<RouteInfo>::value,
+              "RouteInfo is copied with the flit and must stay POD");
+
 #define INFINITE_ 10000
 
 #endif // __MEM_RUBY_NETWORK_GARNET_COMMONTYPES_HH__
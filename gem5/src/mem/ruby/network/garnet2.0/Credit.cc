@@ -42,5 +42,22 @@ Credit::Credit(int vc, bool is_free_signal, Cycles curTime)
     m_id = 0;
     m_vc = vc;
     m_is_free_signal = is_free_signal;
+    m_congestion = 0;
     m_time = curTime;
 }
+
+void
+Credit::serialize(std::vector<uint64_t> &words) const
+{
+    flit::serialize(words);
+    words.push_back(m_is_free_signal);
+    words.push_back(m_congestion);
+}
+
+void
+Credit::unserialize(const std::vector<uint64_t> &words, size_t &pos)
+{
+    flit::unserialize(words, pos);
+    m_is_free_signal = words.at(pos++);
+    m_congestion = words.at(pos++);
+}
@@ -43,7 +43,9 @@
 
 // Credit Signal for buffers inside VC
 // Carries m_vc (inherits from flit.hh)
-// and m_is_free_signal (whether VC is free or not)
+// and m_is_free_signal (whether VC is free or not);
+// under CONGESTION_ routing also the sender's congestion estimate
+// (see OutputUnit::get_congestion())
 
 class Credit : public flit
 {
@@ -52,9 +54,15 @@ class Credit : public flit
     Credit(int vc, bool is_free_signal, Cycles curTime);
 
     bool is_free_signal() { return m_is_free_signal; }
+    int get_congestion() { return m_congestion; }
+    void set_congestion(int congestion) { m_congestion = congestion; }
+
+    void serialize(std::vector<uint64_t> &words) const;
+    void unserialize(const std::vector<uint64_t> &words, size_t &pos);
 
   private:
     bool m_is_free_signal;
+    int m_congestion;
 };
 
 #endif // __MEM_RUBY_NETWORK_GARNET_CREDIT_HH__
@@ -42,6 +42,11 @@ class CreditLink : public NetworkLink
   public:
     typedef CreditLinkParams Params;
     CreditLink(const Params *p) : NetworkLink(p) {}
+
+    void resetState() override;
+
+    void serialize(CheckpointOut &cp) const override;
+    void unserialize(CheckpointIn &cp) override;
 };
 
 #endif // __MEM_RUBY_NETWORK_GARNET_CREDIT_LINK_HH__
@@ -35,6 +35,7 @@
 
 #include "base/stl_helpers.hh"
 #include "debug/RubyNetwork.hh"
+#include "mem/ruby/network/garnet2.0/FlitCheckpoint.hh"
 #include "mem/ruby/network/garnet2.0/OutputUnit.hh"
 #include "mem/ruby/network/garnet2.0/Router.hh"
 
@@ -60,8 +61,11 @@ CrossbarSwitch::init()
 
     m_num_inports = m_router->get_num_inports();
     m_switch_buffer.resize(m_num_inports);
+    // Flits from different VCs of an inport reach the switch in SA
+    // grant order, not in order of their timestamps; keep these
+    // buffers time ordered.
     for (int i = 0; i < m_num_inports; i++) {
-        m_switch_buffer[i] = new flitBuffer();
+        m_switch_buffer[i] = new flitBuffer(INFINITE_, true);
     }
 }
 
@@ -94,6 +98,8 @@ CrossbarSwitch::wakeup()
             // in the next cycle
             m_output_unit[outport]->insert_flit(t_flit);
             m_switch_buffer[inport]->getTopFlit();
+            m_router->get_net_ptr()->traceFlit(FLIT_ST_, t_flit,
+                                               m_router->get_id(), outport);
             m_crossbar_activity++;
         }
     }
@@ -115,4 +121,32 @@ void
 CrossbarSwitch::resetStats()
 {
     m_crossbar_activity = 0;
-}
\ No newline at end of file
+}
+
+void
+CrossbarSwitch::resetState()
+{
+    for (auto switch_buffer : m_switch_buffer)
+        switch_buffer->clear(m_router->get_net_ptr()->getFlitPool());
+}
+
+void
+CrossbarSwitch::serialize(CheckpointOut &cp) const
+{
+    for (int inport = 0; inport < m_num_inports; inport++) {
+        serializeFlitBuffer<flit>(cp, csprintf("switch_buffer%d", inport),
+                                  m_switch_buffer[inport]);
+    }
+}
+
+void
+CrossbarSwitch::unserialize(CheckpointIn &cp)
+{
+    for (int inport = 0; inport < m_num_inports; inport++) {
+        unserializeFlitBuffer(cp, csprintf("switch_buffer%d", inport),
+                              m_switch_buffer[inport],
+                              m_router->get_net_ptr()->getFlitPool());
+        scheduleRestoredFlits(m_router, m_router,
+                              m_switch_buffer[inport]);
+    }
+}
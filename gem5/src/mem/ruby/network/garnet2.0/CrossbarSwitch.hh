@@ -40,11 +40,12 @@
 #include "mem/ruby/common/Consumer.hh"
 #include "mem/ruby/network/garnet2.0/CommonTypes.hh"
 #include "mem/ruby/network/garnet2.0/flitBuffer.hh"
+#include "sim/serialize.hh"
 
 class Router;
 class OutputUnit;
 
-class CrossbarSwitch : public Consumer
+class CrossbarSwitch : public Consumer, public Serializable
 {
   public:
     CrossbarSwitch(Router *router);
@@ -60,6 +61,11 @@ class CrossbarSwitch : public Consumer
 
     uint32_t functionalWrite(Packet *pkt);
     void resetStats();
+    void resetState();
+
+    // flits that won switch allocation (see Router::serialize())
+    void serialize(CheckpointOut &cp) const override;
+    void unserialize(CheckpointIn &cp) override;
 
   private:
     int m_num_vcs;
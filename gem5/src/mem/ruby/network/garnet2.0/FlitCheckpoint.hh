@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET_FLIT_CHECKPOINT_HH__
+#define __MEM_RUBY_NETWORK_GARNET_FLIT_CHECKPOINT_HH__
+
+#include <string>
+#include <vector>
+
+#include "mem/ruby/common/Consumer.hh"
+#include "mem/ruby/network/garnet2.0/flitBuffer.hh"
+#include "mem/ruby/network/garnet2.0/flitPool.hh"
+#include "sim/clocked_object.hh"
+#include "sim/serialize.hh"
+
+// Checkpointing of the flits (or credits, T = Credit) held in a
+// network buffer. All of them go into one array entry, 'name', as a
+// sequence of flit records (see flit::serialize()), so that an empty
+// buffer costs a single line in the checkpoint. Restored flits are
+// taken from 'pool', and buffers keep their FIFO order.
+
+template <class T, class Container>
+void
+serializeFlits(CheckpointOut &cp, const std::string &name,
+               const Container &flits)
+{
+    std::vector<uint64_t> words;
+    for (auto t_flit : flits)
+        static_cast<const T *>(t_flit)->serialize(words);
+    arrayParamOut(cp, name, words);
+}
+
+template <class T>
+std::vector<T *>
+unserializeFlits(CheckpointIn &cp, const std::string &name,
+                 flitPool<T> &pool)
+{
+    std::vector<uint64_t> words;
+    arrayParamIn(cp, name, words);
+
+    std::vector<T *> flits;
+    size_t pos = 0;
+    while (pos < words.size()) {
+        T *t_flit = pool.allocate();
+        t_flit->unserialize(words, pos);
+        flits.push_back(t_flit);
+    }
+    return flits;
+}
+
+template <class T>
+void
+serializeFlitBuffer(CheckpointOut &cp, const std::string &name,
+                    const flitBuffer *buffer)
+{
+    std::vector<flit *> flits;
+    for (int i = 0; i < buffer->getSize(); i++)
+        flits.push_back(buffer->flitAt(i));
+    serializeFlits<T>(cp, name, flits);
+}
+
+template <class T>
+void
+unserializeFlitBuffer(CheckpointIn &cp, const std::string &name,
+                      flitBuffer *buffer, flitPool<T> &pool)
+{
+    assert(buffer->isEmpty());
+    for (auto t_flit : unserializeFlits(cp, name, pool))
+        buffer->insert(t_flit);
+}
+
+// Nothing was scheduled for the flits of a restored buffer: wake its
+// consumer once per flit, no earlier than the flit is due, since the
+// links, routers and NIs move one flit per queue per wakeup. Every
+// wakeup of the checkpoint cycle ran before the checkpoint was taken,
+// so a flit that was already due is picked up in the next cycle, as
+// it would have been without the checkpoint.
+inline void
+scheduleRestoredFlits(Consumer *consumer, const Clocked *clock,
+                      const flitBuffer *buffer)
+{
+    Cycles now = clock->curCycle();
+    Cycles when = now + Cycles(1);
+    for (int i = 0; i < buffer->getSize(); i++) {
+        when = std::max(when, buffer->flitAt(i)->get_time());
+        consumer->scheduleEventAbsolute(clock->clockEdge(when - now));
+        ++when;
+    }
+}
+
+#endif // __MEM_RUBY_NETWORK_GARNET_FLIT_CHECKPOINT_HH__
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "mem/ruby/network/garnet2.0/FlitTrace.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+FlitTrace::FlitTrace(const std::string &file_name, uint32_t num_records)
+    : m_head(0), m_tail(0), m_closing(false)
+{
+    m_size = 64;
+    while (m_size < num_records)
+        m_size <<= 1;
+    m_mask = m_size - 1;
+    m_ring.resize(m_size);
+
+    m_out = simout.create(file_name, true);
+
+    FlitTraceHeader header;
+    memset(&header, 0, sizeof(header));
+    strncpy(header.magic, GARNET_FLIT_TRACE_MAGIC, sizeof(header.magic));
+    header.version = GARNET_FLIT_TRACE_VERSION;
+    header.record_size = sizeof(FlitTraceRecord);
+    header.ticks_per_second = SimClock::Frequency;
+    m_out->stream()->write((const char *) &header, sizeof(header));
+
+    m_writer = std::thread([this]{ writerLoop(); });
+}
+
+FlitTrace::~FlitTrace()
+{
+    close();
+}
+
+void
+FlitTrace::close()
+{
+    if (!m_out)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closing = true;
+    }
+    m_cv.notify_one();
+    m_writer.join();
+
+    simout.close(m_out);
+    m_out = NULL;
+}
+
+// The ring is full: wake the writer and wait for it to free a slot.
+void
+FlitTrace::waitForSpace(uint64_t head)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.notify_one();
+    m_space_cv.wait(lock, [this, head]{
+        return head - m_tail.load(std::memory_order_acquire) < m_size; });
+}
+
+void
+FlitTrace::writerLoop()
+{
+    std::ostream *os = m_out->stream();
+
+    while (true) {
+        bool closing;
+        {
+            // the timeout covers a notify from record() that raced
+            // with the check below
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait_for(lock, std::chrono::milliseconds(10), [this]{
+                return m_closing ||
+                    m_head.load(std::memory_order_acquire) -
+                    m_tail.load(std::memory_order_relaxed) >= m_size / 4; });
+            closing = m_closing;
+        }
+
+        uint64_t head = m_head.load(std::memory_order_acquire);
+        uint64_t tail = m_tail.load(std::memory_order_relaxed);
+        while (tail != head) {
+            // contiguous run up to the end of the ring
+            uint64_t start = tail & m_mask;
+            uint64_t count = std::min(head - tail, m_size - start);
+            os->write((const char *) &m_ring[start],
+                      count * sizeof(FlitTraceRecord));
+            tail += count;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tail.store(tail, std::memory_order_release);
+        }
+        m_space_cv.notify_all();
+
+        // the simulator does not record once close() is called
+        if (closing)
+            break;
+    }
+    os->flush();
+}
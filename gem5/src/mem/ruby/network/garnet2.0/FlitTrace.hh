@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET_FLIT_TRACE_HH__
+#define __MEM_RUBY_NETWORK_GARNET_FLIT_TRACE_HH__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "base/output.hh"
+#include "base/types.hh"
+#include "sim/core.hh"
+
+// Flit lifecycle trace, enabled with the network's flit_trace param
+// and converted to Chrome/Perfetto JSON by util/garnet_flit_trace.py.
+//
+// The simulator thread appends fixed-size records to a ring buffer;
+// a writer thread drains it to the file in the background, so the
+// simulator only blocks when the ring is full. With tracing off the
+// network holds no FlitTrace and every hook is one pointer test.
+//
+// File layout: FlitTraceHeader, then FlitTraceRecords until the end.
+
+enum FlitTraceEvent {
+    FLIT_INJECT_ = 0,   // NI sends the flit onto its link
+    FLIT_LT_ = 1,       // flit arrives at a router input port
+    FLIT_RC_ = 2,       // route computed for a head flit
+    FLIT_SA_ = 3,       // switch allocation granted
+    FLIT_ST_ = 4,       // switch traversal
+    FLIT_SWAP_OUT_ = 5, // flit leaves its router in a swap
+    FLIT_SWAP_IN_ = 6,  // flit enters a router in a swap
+    FLIT_BAIL_OUT_ = 7, // bail-out sequence started for this flit
+    FLIT_EJECT_ = 8,    // NI receives the flit
+    NUM_FLIT_TRACE_EVENTS_
+};
+
+#define GARNET_FLIT_TRACE_MAGIC "GNFTRACE"
+#define GARNET_FLIT_TRACE_VERSION 1
+
+struct FlitTraceHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t ticks_per_second;
+};
+
+struct FlitTraceRecord
+{
+    uint64_t tick;
+    uint64_t packet_id;
+    int16_t location; // router id, or NI id for inject/eject
+    uint8_t event;    // FlitTraceEvent
+    uint8_t port;     // inport or outport at the router, 0xff if none
+    uint16_t vc;
+    uint16_t flit_id;
+};
+
+class FlitTrace
+{
+  public:
+    FlitTrace(const std::string &file_name, uint32_t num_records);
+    ~FlitTrace();
+
+    void
+    record(FlitTraceEvent event, uint64_t packet_id, int flit_id,
+           int location, int port, int vc)
+    {
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == m_size)
+            waitForSpace(head);
+
+        FlitTraceRecord &rec = m_ring[head & m_mask];
+        rec.tick = curTick();
+        rec.packet_id = packet_id;
+        rec.location = location;
+        rec.event = event;
+        rec.port = (port < 0) ? 0xff : port;
+        rec.vc = vc;
+        rec.flit_id = flit_id;
+        m_head.store(head + 1, std::memory_order_release);
+
+        // hand a quarter of the ring to the writer at a time
+        if (((head + 1) & (m_size / 4 - 1)) == 0)
+            m_cv.notify_one();
+    }
+
+    // write out whatever is buffered and stop the writer thread
+    void close();
+
+  private:
+    void waitForSpace(uint64_t head);
+    void writerLoop();
+
+    OutputStream *m_out;
+    std::vector<FlitTraceRecord> m_ring;
+    uint64_t m_size; // power of two
+    uint64_t m_mask;
+    // m_head is only written by the simulator, m_tail by the writer
+    std::atomic<uint64_t> m_head;
+    std::atomic<uint64_t> m_tail;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;       // wakes the writer
+    std::condition_variable m_space_cv; // wakes a blocked simulator
+    bool m_closing;
+    std::thread m_writer;
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET_FLIT_TRACE_HH__
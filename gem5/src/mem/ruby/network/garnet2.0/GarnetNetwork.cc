@@ -33,8 +33,11 @@
 
 #include "mem/ruby/network/garnet2.0/GarnetNetwork.hh"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 
+#include "base/callback.hh"
 #include "base/cast.hh"
 #include "base/stl_helpers.hh"
 #include "debug/RubyNetwork.hh"
@@ -51,6 +54,8 @@
 #include "mem/ruby/network/garnet2.0/InputUnit.hh"
 #include "mem/ruby/network/garnet2.0/OutputUnit.hh"
 #include "mem/ruby/system/RubySystem.hh"
+#include "sim/core.hh"
+#include "sim/sim_exit.hh"
 
 #include "mem/ruby/network/garnet2.0/flit.hh"
 //end
@@ -65,7 +70,10 @@ using m5::stl_helpers::deletePointers;
  */
 
 GarnetNetwork::GarnetNetwork(const Params *p)
-    : Network(p)
+    : Network(p),
+      m_drain_event([this]{ checkDrained(); }, "GarnetNetwork drain"),
+      m_telemetry_event([this]{ sampleTelemetry(); },
+                        "GarnetNetwork telemetry")
 {
     m_num_rows = p->num_rows;
     m_ni_flit_size = p->ni_flit_size;
@@ -73,14 +81,13 @@ GarnetNetwork::GarnetNetwork(const Params *p)
     m_buffers_per_data_vc = p->buffers_per_data_vc;
     m_buffers_per_ctrl_vc = p->buffers_per_ctrl_vc;
     m_routing_algorithm = p->routing_algorithm;
+    m_congestion_delay = Cycles(p->congestion_delay);
+    m_congestion_regional = p->congestion_regional;
+    m_random_seed = p->random_seed;
+    m_bitmask_sw_alloc = p->bitmask_sw_alloc;
+    m_multi_flit = p->multi_flit;
 
-    max_flit_latency = Cycles(0);
-    max_flit_network_latency = Cycles(0);
-    max_flit_queueing_latency = Cycles(0);
-
-    min_flit_latency = Cycles(999999); // 1 million
-    min_flit_network_latency = Cycles(999999);
-    min_flit_queueing_latency = Cycles(999999);
+    m_packet_latency_rec.resize(m_virtual_networks);
 
     print_trigger = Cycles(100); // init with 100
 	// interswap-defaults
@@ -89,8 +96,24 @@ GarnetNetwork::GarnetNetwork(const Params *p)
     m_whenToSwap = p->whenToSwap;
     m_whichToSwap = p->whichToSwap;
     m_no_is_swap = p->no_is_swap;
+    m_swap_stall_threshold = Cycles(p->swap_stall_threshold);
     m_occupancy_swap = p->occupancy_swap;
     m_inj_single_vnet = p->inj_single_vnet;
+    m_total_packets_received = 0;
+    m_warmup_cycles = p->warmup_cycles;
+    m_measure_cycles = p->measure_cycles;
+    m_measured_in_flight = 0;
+    m_swap_epoch = Cycles(0);
+    m_telemetry_period = p->telemetry_period;
+    m_telemetry_file = p->telemetry_file;
+    m_telemetry_out = NULL;
+    m_flit_trace_enabled = p->flit_trace;
+    m_flit_trace_file = p->flit_trace_file;
+    m_flit_trace_buffer = p->flit_trace_buffer;
+    m_flit_trace = NULL;
+    m_next_packet_id = 0;
+    m_num_partitions = 1;
+    m_partition_sync = NULL;
 
     cout << "m_inj_single_vnet: " << m_inj_single_vnet << endl;
     if (m_inj_single_vnet == 0) {
@@ -161,6 +184,16 @@ GarnetNetwork::GarnetNetwork(const Params *p)
                         "of the frequency of swaps compared to default policy" << endl;
                 cout << "***********************************" << endl;
             #endif
+        } else if (m_whenToSwap == ADAPTIVE_) {
+            #if (MY_PRINT)
+                cout << "***********************************" << endl;
+                cout << " 'whenToSwap' :::: " << endl;
+                cout << "Swaps will be initiated by any router whose "\
+                        "swap_ptr flit is stalled (or inport is occupied) "\
+                        "beyond the threshold, on the cycles of its "\
+                        "checkerboard colour" << endl;
+                cout << "***********************************" << endl;
+            #endif
         } else {
             #if (MY_PRINT)
                 cout << "***********************************" << endl;
@@ -253,6 +286,11 @@ GarnetNetwork::init()
     // parent network constructor
     assert(m_topology_ptr != NULL);
     m_topology_ptr->createLinks(this);
+    // every outport has its routing table entry now
+    for (auto router : m_routers)
+        router->get_routingUnit_ref()->buildRouteTable(m_nodes);
+    colourRouters();
+    initPartitions();
 
     // Initialize topology specific parameters
     if (getNumRows() > 0) {
@@ -266,6 +304,7 @@ GarnetNetwork::init()
         m_num_rows = -1;
         m_num_cols = -1;
     }
+    m_dist_latency_rec.resize(getNumDistClasses());
 
     // FaultModel: declare each router to the fault model
     if (isFaultModelEnabled()) {
@@ -284,6 +323,38 @@ GarnetNetwork::init()
         }
     }
 	Sequencer::gnet = this;
+
+    if (m_measure_cycles > 0)
+        scheduleNetworkEvent(m_drain_event,
+                             m_warmup_cycles + m_measure_cycles);
+
+    if (m_telemetry_period > 0) {
+        m_telemetry_out = simout.create(m_telemetry_file, true);
+
+        TelemetryHeader header;
+        memset(&header, 0, sizeof(header));
+        strncpy(header.magic, GARNET_TELEMETRY_MAGIC, sizeof(header.magic));
+        header.version = GARNET_TELEMETRY_VERSION;
+        header.period = m_telemetry_period;
+        header.num_routers = m_routers.size();
+        header.num_links = m_networklinks.size();
+
+        ostream *os = m_telemetry_out->stream();
+        os->write((const char *) &header, sizeof(header));
+        os->write((const char *) m_link_info.data(),
+                  m_link_info.size() * sizeof(TelemetryLinkInfo));
+
+        m_telemetry_link_last.resize(m_networklinks.size(), 0);
+        scheduleNetworkEvent(m_telemetry_event,
+                             clockEdge(Cycles(m_telemetry_period)));
+    }
+
+    if (m_flit_trace_enabled) {
+        m_flit_trace = new FlitTrace(m_flit_trace_file, m_flit_trace_buffer);
+        // the writer thread has to finish before the simulator exits
+        registerExitCallback(
+            new MakeCallback<FlitTrace, &FlitTrace::close>(m_flit_trace));
+    }
     // for deadlock detection; if want to do periodically
     last_probe = 0;
 }
@@ -292,6 +363,10 @@ GarnetNetwork::~GarnetNetwork()
 {
     deletePointers(m_routers);
     deletePointers(m_nis);
+    if (m_telemetry_out)
+        simout.close(m_telemetry_out);
+    delete m_flit_trace;
+    delete m_partition_sync;
     deletePointers(m_networklinks);
     deletePointers(m_creditlinks);
 }
@@ -316,10 +391,13 @@ GarnetNetwork::makeExtInLink(NodeID src, SwitchID dest, BasicLink* link,
     net_link->setType(EXT_IN_);
     CreditLink* credit_link = garnet_link->m_credit_links[LinkDirection_In];
 
+    net_link->init_net_ptr(this);
+    credit_link->init_net_ptr(this);
     m_networklinks.push_back(net_link);
     m_creditlinks.push_back(credit_link);
+    m_link_info.push_back({-1, (int32_t) dest, EXT_IN_});
 
-    PortDirection dst_inport_dirn = "Local";
+    PortDirection dst_inport_dirn = PortDirection_Local;
     m_routers[dest]->addInPort(dst_inport_dirn, net_link, credit_link);
     m_nis[src]->addOutPort(net_link, credit_link, dest);
 }
@@ -345,10 +423,13 @@ GarnetNetwork::makeExtOutLink(SwitchID src, NodeID dest, BasicLink* link,
     net_link->setType(EXT_OUT_);
     CreditLink* credit_link = garnet_link->m_credit_links[LinkDirection_Out];
 
+    net_link->init_net_ptr(this);
+    credit_link->init_net_ptr(this);
     m_networklinks.push_back(net_link);
     m_creditlinks.push_back(credit_link);
+    m_link_info.push_back({(int32_t) src, -1, EXT_OUT_});
 
-    PortDirection src_outport_dirn = "Local";
+    PortDirection src_outport_dirn = PortDirection_Local;
     m_routers[src]->addOutPort(src_outport_dirn, net_link,
                                routing_table_entry,
                                link->m_weight, credit_link);
@@ -373,13 +454,56 @@ GarnetNetwork::makeInternalLink(SwitchID src, SwitchID dest, BasicLink* link,
     net_link->setType(INT_);
     CreditLink* credit_link = garnet_link->m_credit_link;
 
+    net_link->init_net_ptr(this);
+    credit_link->init_net_ptr(this);
     m_networklinks.push_back(net_link);
     m_creditlinks.push_back(credit_link);
+    m_link_info.push_back({(int32_t) src, (int32_t) dest, INT_});
 
     m_routers[dest]->addInPort(dst_inport_dirn, net_link, credit_link);
     m_routers[src]->addOutPort(src_outport_dirn, net_link,
                                routing_table_entry,
                                link->m_weight, credit_link);
+
+    // Remember who is at the other end of the link; SWAP finds its
+    // neighbours from these instead of from the topology geometry.
+    int dst_inport = m_routers[dest]->get_num_inports() - 1;
+    int src_outport = m_routers[src]->get_num_outports() - 1;
+    m_routers[src]->setOutportNeighbour(src_outport, dest, dst_inport);
+    m_routers[dest]->setInportNeighbour(dst_inport, src);
+}
+
+/*
+ * Greedy colouring of the router graph (routers connected by an
+ * internal link in either direction are neighbours). Under the
+ * ADAPTIVE_ 'whenToSwap' policy a router initiates swaps only on the
+ * cycles of its colour, so two neighbours never initiate together.
+ * A mesh gets the usual two-colour checkerboard.
+ */
+void
+GarnetNetwork::colourRouters()
+{
+    m_num_swap_colours = 1;
+    for (int i = 0; i < m_routers.size(); i++) {
+        Router *router = m_routers[i];
+        std::vector<bool> taken(m_routers.size() + 1, false);
+        for (int outport = 0; outport < router->get_num_outports();
+             outport++) {
+            int nbr = router->get_downstreamId(outport);
+            if (nbr != -1 && nbr < i)
+                taken[m_routers[nbr]->get_swap_colour()] = true;
+        }
+        for (int inport = 0; inport < router->get_num_inports(); inport++) {
+            int nbr = router->get_upstreamId(inport);
+            if (nbr != -1 && nbr < i)
+                taken[m_routers[nbr]->get_swap_colour()] = true;
+        }
+        int colour = 0;
+        while (taken[colour])
+            colour++;
+        router->set_swap_colour(colour);
+        m_num_swap_colours = std::max(m_num_swap_colours, colour + 1);
+    }
 }
 
 // Total routers in the network
@@ -397,100 +521,61 @@ GarnetNetwork::get_router_id(int ni)
 }
 
 int
-GarnetNetwork::get_downstreamId( PortDirection outport_dir, int upstream_id )
+GarnetNetwork::get_downstreamId(int outport, int upstream_id)
 {
-    int num_cols = getNumCols();
-    int downstream_id = -1; // router_id for downstream router
-    /*outport direction fromt he flit for this router*/
-    if (outport_dir == "East") {
-        downstream_id = upstream_id + 1;
-    }
-    else if (outport_dir == "West") {
-        downstream_id = upstream_id - 1;
-    }
-    else if (outport_dir == "North") {
-        downstream_id = upstream_id + num_cols;
-    }
-    else if (outport_dir == "South") {
-        downstream_id = upstream_id - num_cols;
-    }
-    else if (outport_dir == "Local"){
-        #if (MY_PRINT)
-            cout << "outport_dir: " << outport_dir << endl;
-        #endif
-        assert(0);
-        return -1;
-    }
-    else {
-        #if (MY_PRINT)
-            cout << "outport_dir: " << outport_dir << endl;
-        #endif
-        assert(0); // for completion of if-else chain
-        return -1;
-    }
+    return m_routers[upstream_id]->get_downstreamId(outport);
+}
 
-    return downstream_id;
+int
+GarnetNetwork::get_downstreamInport(int outport, int upstream_id)
+{
+    return m_routers[upstream_id]->get_downstreamInport(outport);
 }
 
 Router*
 GarnetNetwork::get_downstreamRouter(PortDirection outport_dir, int upstream_id)
 {
-    int router_id = -1;
-    router_id = get_downstreamId( outport_dir, upstream_id);
-//    cout << "downstream router-id: " << router_id << endl;
-    // assert(router_id >= 0);
-    if ((router_id < 0) || (router_id >= getNumRouters()))
-        return NULL;
+    int outport = m_routers[upstream_id]->get_routingUnit_ref()->\
+                    m_outports_dirn2idx[outport_dir];
+    if (outport == -1)
+        return NULL; // no outport in that dirn
+
+    int router_id = get_downstreamId(outport, upstream_id);
+    if (router_id == -1)
+        return NULL; // outport goes to an NI
     else
         return m_routers[router_id];
 }
 
 
-PortDirection
-GarnetNetwork::get_downstreamDirn( PortDirection outport_dir )
-{
-    // 'inport_dirn' of the downstream router
-    // NOTE: it's Mesh specific
-    PortDirection inport_dirn;
-    if (outport_dir == "East") {
-        inport_dirn = "West";
-    } else if (outport_dir == "West") {
-        inport_dirn = "East";
-    } else if (outport_dir == "North") {
-        inport_dirn = "South";
-    } else if (outport_dir == "South") {
-        inport_dirn = "North";
-    } else if (outport_dir == "Local") {
-        assert(0); // shouldn't come here,,,
-    }
-
-    return inport_dirn;
-}
-
-
 // if this fucntion returns 'true' initiate bail_out sequence.
-// NOte: it still do bail-put signalling based on invc 0 for ech
-// inport.
-// That is, if outport of flit at invc0 has all downstream router's
-// `is_swap` bit set then it will trigger the bailout sequence.
-// Implecation: More false positives.. not incorrect.
-// Reason: Can introduce many bugs; more code addition wo incentive
+// The symptom is checked in two steps:
+// 1. cheap filter: the upstream router holds its `is_swap` bit and the
+//    flit pointed to by swap_ptr has been stuck at the head of its vc
+//    for at least m_swap_stall_threshold cycles. The head-of-vc time is
+//    kept by the InputUnit as flits arrive and leave, so this is O(1).
+// 2. only then, the bail_out matrix below: every non-empty vc (of this
+//    vnet) of the upstream router must be waiting on a downstream inport
+//    which is completely full and whose router also holds `is_swap`.
+//    If some vc is not blocked that way, swap_ptr is moved to it
+//    instead and no bail-out is needed.
 bool
 GarnetNetwork::chk_deadlck_symptm(int my_id, int vnet)
 {
+    Router* router = m_routers[my_id];
+    if (router->is_swap == false)
+        return false;
 
-
-
-    if(curCycle()%1000 == 0)
-        return true;
-     else
+    assert((router->swap_ptr.inport != -1) && (router->swap_ptr.vcid != -1));
+    InputUnit *swap_unit = router->get_inputUnit_ref()[router->swap_ptr.inport];
+    if (swap_unit->get_stall_cycles(router->swap_ptr.vcid,
+                                    router->curCycle()) <
+        m_swap_stall_threshold)
         return false;
-    // -----------------------------
 
     // movSwapPtr in the end.. first peekTopFlit() of upstream
     // after checking vc_isEmpty; then check the correspnding
     // `is_swap` bit of downstream.
-    Router* router = m_routers[my_id];
     // loop over its inport starting from swap_ptr.inport
     uint32_t orig_inport = router->swap_ptr.inport;
     uint32_t inport_itr = router->swap_ptr.inport;
@@ -501,7 +586,6 @@ GarnetNetwork::chk_deadlck_symptm(int my_id, int vnet)
     std::vector<std::vector<int>> bail_out(num_inports);
     //bail_out.resize(router->get_num_inports());
     int downstreamId;
-    PortDirection downstreamInportDirn;
     int downstreamInportId;
 
     int vcs_per_vnet = router->get_vc_per_vnet();
@@ -534,24 +618,25 @@ GarnetNetwork::chk_deadlck_symptm(int my_id, int vnet)
         assert(upstreamVcId != -1); // vcid shouldn't be -1
         // loop over all the invc for this given inport of upstream router
         for(int in_vc = vc_base; in_vc < vc_base + vcs_per_vnet; ++in_vc) {
-
+            // bail_out is indexed by the vc within this vnet
+            int vc_idx = in_vc - vc_base;
+            flit_ = NULL;
             if (router->get_inputUnit_ref()[inport_itr]->vc_isEmpty(in_vc) == false)
                 flit_ = router->get_inputUnit_ref()[inport_itr]->peekTopFlit(in_vc);
             else
-                bail_out[inport_itr][in_vc] = -1; // mark the given entry in vec as empty
+                bail_out[inport_itr][vc_idx] = -1; // mark the given entry in vec as empty
 
             if (flit_ != NULL) {
                 // cout << *flit_ << endl;
                 // we are successfully able to peek the flit of upstream router
                 // assert(flit_->get_vnet() == 0);
                 PortDirection outport_dir = flit_->get_outport_dir();
-                if(outport_dir == "Local") // Exceptional case
+                if(outport_dir == PortDirection_Local) // Exceptional case
                     return false; // we don't need to bail-out as this flit is going to be ejected
-                downstreamId = get_downstreamId(outport_dir, my_id);
-                downstreamInportDirn = get_downstreamDirn(outport_dir);
-                assert(downstreamInportDirn != "Local");
-                downstreamInportId = m_routers[downstreamId]->get_routingUnit_ref()\
-                                            ->m_inports_dirn2idx[downstreamInportDirn];
+                downstreamId = get_downstreamId(flit_->get_outport(), my_id);
+                downstreamInportId =
+                    get_downstreamInport(flit_->get_outport(), my_id);
+                assert(downstreamId != -1 && downstreamInportId != -1);
                 int vc;
                 for(vc = vc_base; vc < vc_base + m_vcs_per_vnet; vc++) {
                     if ((m_routers[downstreamId]->is_swap == true) &&
@@ -562,12 +647,12 @@ GarnetNetwork::chk_deadlck_symptm(int my_id, int vnet)
                         break; // either `is_swap` is false or vc is empty (don't bailOut)
                 }
                 if (vc == (vc_base + m_vcs_per_vnet))
-                    bail_out[inport_itr][in_vc] = 1; // need to bail_out
+                    bail_out[inport_itr][vc_idx] = 1; // need to bail_out
                 else
-                    bail_out[inport_itr][in_vc] = 7; // don't bail_out
+                    bail_out[inport_itr][vc_idx] = 7; // don't bail_out
 
             } else {
-                assert(bail_out[inport_itr][in_vc] == -1); // empty inport at upstream rout
+                assert(bail_out[inport_itr][vc_idx] == -1); // empty inport at upstream rout
             }
         }
     }
@@ -598,12 +683,13 @@ GarnetNetwork::chk_deadlck_symptm(int my_id, int vnet)
             assert(bail_out[inport][in_vc] != 0);
             if (bail_out[inport][in_vc] == 7) {
 
-                if ((router->get_inputUnit_ref()[inport]->vc_isEmpty(in_vc) == false) &&
-                    (router->getInportDirection(inport) != "Local")) {
+                if ((router->get_inputUnit_ref()[inport]->vc_isEmpty(vc_base + in_vc) == false) &&
+                    (router->getInportDirection(inport) !=
+                     PortDirection_Local)) {
                     router->swap_ptr.inport = inport;
                     router->swap_ptr.inport_dirn = router\
                     ->get_inputUnit_ref()[router->swap_ptr.inport]->get_direction();
-                    router->swap_ptr.vcid = in_vc; // because we are making sure vcid0 is not empty
+                    router->swap_ptr.vcid = vc_base + in_vc; // because we are making sure vcid0 is not empty
                 }
                 return false; // this will return wo completing the loop
            }
@@ -630,15 +716,13 @@ GarnetNetwork::bail_out(int my_id)
     assert((upstreamInport != -1) && (upstreamVcId != -1));
     assert(router->get_inputUnit_ref()[upstreamInport]->vc_isEmpty(upstreamVcId) == false);
     flit* flit_ = router->get_inputUnit_ref()[upstreamInport]->peekTopFlit(upstreamVcId);
-    PortDirection outport_dir = flit_->get_outport_dir();
-    int downstream_id = get_downstreamId(outport_dir, my_id);
+    int downstream_id = get_downstreamId(flit_->get_outport(), my_id);
+    assert(downstream_id != -1);
     Router* dnstream_router = m_routers[downstream_id];
     assert(vcs_per_vnet == dnstream_router->get_vc_per_vnet());
-    // inport direction of downstream router
-    PortDirection inport_dirn = get_downstreamDirn(outport_dir);
-    assert(inport_dirn != "Local");
-    int downstream_inport_id =
-        dnstream_router->get_routingUnit_ref()->m_inports_dirn2idx[inport_dirn];
+    // inport of downstream router
+    int downstream_inport_id = get_downstreamInport(flit_->get_outport(), my_id);
+    traceFlit(FLIT_BAIL_OUT_, flit_, my_id, upstreamInport);
     // assert(dnstream_router->is_swap == true);
     // assert(router->is_swap == true);
 
@@ -683,26 +767,32 @@ GarnetNetwork::bail_out(int my_id)
 
 // interSwap function
 // called by upstream router fo make guarantteed forward
-// progress of the flit.
-flit*
-GarnetNetwork::doSwap(flit *flit_t, int upstream_id)
+// progress of the flit. Swaps the whole packet 'pkt' (head flit first)
+// with a packet of the same length at the downstream router, which is
+// returned in 'swapped_pkt'.
+bool
+GarnetNetwork::doSwap(const std::vector<flit *>& pkt, int upstream_id,
+                      std::vector<flit *>& swapped_pkt)
 {
     #if (MY_PRINT)
         cout << "GarnetNetwork::doSwap()" << endl;
     #endif
 
+    // the head flit of the upstream packet
+    flit *flit_t = pkt[0];
 	int downstream_id = -1;
-    PortDirection inport_dirn = "Unknown";
-	/*outport direction from the flit for this router*/
-	PortDirection outport_dir = flit_t->get_outport_dir();
+    int inport_id = -1;
+	/*outport from the flit for this router*/
+	int outport = flit_t->get_outport();
     #if (MY_PRINT)
-        cout << "Head-flit's outport_dir: " <<  outport_dir << endl;
-        cout <<  "Head-flit's outport: " << flit_t->get_outport() << endl;
+        cout << "Head-flit's outport_dir: " <<  flit_t->get_outport_dir() << endl;
+        cout <<  "Head-flit's outport: " << outport << endl;
     #endif
 
-    downstream_id = get_downstreamId(outport_dir, upstream_id);
-    // inport dirn at (wrt) downstream router
-    inport_dirn = get_downstreamDirn(outport_dir);
+    downstream_id = get_downstreamId(outport, upstream_id);
+    // inport at (wrt) downstream router
+    inport_id = get_downstreamInport(outport, upstream_id);
+    assert(downstream_id != -1 && inport_id != -1);
 	// Only do swap when is_swap bit is low
 	// after doing the swap set it high at
 	// downstream router...
@@ -712,21 +802,21 @@ GarnetNetwork::doSwap(flit *flit_t, int upstream_id)
         if ((m_routers[downstream_id]->is_swap == false) &&
             (m_routers[downstream_id]->swap_ptr.valid == true)) {
             // get the flit from downstream router..
-            // this 'inport_dirn' is of downstream router
+            // this 'inport_id' is of downstream router
             // we do swap with *SAME* vcid of the downstream router as indicated by
             // the swap_ptr of upstream router...
             int vcid = m_routers[upstream_id]->swap_ptr.vcid;
             assert(vcid == flit_t->get_vc());
-            flit* flit1_t = m_routers[downstream_id]->doSwap(inport_dirn, vcid);
-            if (flit1_t == NULL) {
+            if (!m_routers[downstream_id]->doSwap(inport_id, vcid,
+                                                  pkt.size(), swapped_pkt)) {
                 // this means that queue at downstream router is empty OR
                 // mis-routed flit has Local outport
                 // do not do the swap
-                return NULL;
+                return false;
             } else {
                 #if (MY_PRINT)
                     cout << "GarnetNetwork::doSwap Received a flit from downstream router" << endl;
-                    cout <<  *flit1_t << endl;
+                    cout <<  *swapped_pkt[0] << endl;
                 #endif
                 // set 'is_swap' bit here.. this is done to
                 // avoid the routed flit (which has made forward)
@@ -743,13 +833,13 @@ GarnetNetwork::doSwap(flit *flit_t, int upstream_id)
                     cout << "GarnetNetwork::doSwap upstream_id: " << upstream_id << endl;
                     cout << "GarnetNetwork::doSwap downstream_id: " << downstream_id << endl;
                 #endif
-                m_routers[downstream_id]->doSwap_enqueue(flit_t, inport_dirn, -1, vcid);
-                return flit1_t;
+                m_routers[downstream_id]->doSwap_enqueue(pkt, inport_id, vcid, true);
+                return true;
             }
         }
         else {
 
-            return NULL;
+            return false;
         }
 	}
     else if ( m_no_is_swap == 1 ) {
@@ -757,21 +847,20 @@ GarnetNetwork::doSwap(flit *flit_t, int upstream_id)
 
             int vcid = m_routers[upstream_id]->swap_ptr.vcid;
             assert(vcid == flit_t->get_vc());
-            flit* flit1_t = m_routers[downstream_id]->\
-                            doSwap(inport_dirn, vcid);
-            if (flit1_t == NULL) {
+            if (!m_routers[downstream_id]->\
+                            doSwap(inport_id, vcid, pkt.size(), swapped_pkt)) {
                 #if (MY_PRINT)
                 cout << "SWAP failed because downstream router did not return SWAP-back flit" << endl;
                 #endif
                 // this means that queue at downstream router is empty OR
                 // mis-routed flit has Local outport
                 // do not do the swap
-                return NULL;
+                return false;
             } else {
                 #if (MY_PRINT)
                     cout << "GarnetNetwork::doSwap Received " \
                             "a flit from downstream router" << endl;
-                    cout <<  *flit1_t << endl;
+                    cout <<  *swapped_pkt[0] << endl;
                 #endif
 
                 #if (MY_PRINT)
@@ -787,8 +876,8 @@ GarnetNetwork::doSwap(flit *flit_t, int upstream_id)
                             << downstream_id << endl;
                 #endif
                 m_routers[downstream_id]->\
-                            doSwap_enqueue(flit_t, inport_dirn, -1, vcid);
-                return flit1_t;
+                            doSwap_enqueue(pkt, inport_id, vcid, true);
+                return true;
             }
         }
         else {
@@ -798,14 +887,15 @@ GarnetNetwork::doSwap(flit *flit_t, int upstream_id)
             // the 'is_swap' bit at downstream router is already set..
             // OR,
             // swap_ptr at downstream router is not valid
-            // don't do the swap; return NULL
-            return NULL;
+            // don't do the swap; return false
+            return false;
         }
 	} else {
         assert(0);
 	}
 
     assert(0);
+    return false;
 }
 
 // scanNetwork function to loop through all routers
@@ -876,59 +966,6 @@ GarnetNetwork::scanNetwork()
     return;
 }
 
-int
-GarnetNetwork::get_upstreamId( PortDirection inport_dir, int my_id )
-{
-    int num_cols = getNumCols();
-    int upstream_id = -1; // router_id for downstream router
-    /*outport direction fromt he flit for this router*/
-    if (inport_dir == "East") {
-        upstream_id = my_id + 1;
-    }
-    else if (inport_dir == "West") {
-        upstream_id = my_id - 1;
-    }
-    else if (inport_dir == "North") {
-        upstream_id = my_id + num_cols;
-    }
-    else if (inport_dir == "South") {
-        upstream_id = my_id - num_cols;
-    }
-    else if (inport_dir == "Local") {
-        upstream_id = my_id;
-        #if (MY_PRINT)
-            cout << "inport_dir: " << inport_dir << endl;
-        #endif
-        // assert(0);
-        // return -1;
-    }
-    else {
-        #if (MY_PRINT)
-            cout << "inport_dir: " << inport_dir << endl;
-        #endif
-        assert(0); // for completion of if-else chain
-        return -1;
-    }
-
-    return upstream_id;
-}
-
-
-Router*
-GarnetNetwork::get_upstreamrouter(PortDirection inport_dir, int upstream_id)
-{
-    int router_id = -1;
-    router_id = get_upstreamId( inport_dir, upstream_id);
-//    cout << "downstream router-id: " << router_id << endl;
-    // assert(router_id >= 0);
-    if ((router_id < 0) || (router_id >= getNumRouters()))
-        return NULL;
-    else
-        return m_routers[router_id];
-}
-
-
-
 void
 GarnetNetwork::regStats()
 {
@@ -993,6 +1030,52 @@ GarnetNetwork::regStats()
     m_min_flit_queueing_latency
         .name(name() + ".min_flit_queueing_latency");
 
+    m_packet_latency_p50
+        .init(m_virtual_networks)
+        .name(name() + ".packet_latency_p50")
+        .flags(Stats::nozero | Stats::oneline)
+        ;
+    m_packet_latency_p99
+        .init(m_virtual_networks)
+        .name(name() + ".packet_latency_p99")
+        .flags(Stats::nozero | Stats::oneline)
+        ;
+    m_packet_latency_p999
+        .init(m_virtual_networks)
+        .name(name() + ".packet_latency_p999")
+        .flags(Stats::nozero | Stats::oneline)
+        ;
+
+    for (int i = 0; i < m_virtual_networks; i++) {
+        m_packet_latency_p50.subname(i, csprintf("vnet-%i", i));
+        m_packet_latency_p99.subname(i, csprintf("vnet-%i", i));
+        m_packet_latency_p999.subname(i, csprintf("vnet-%i", i));
+    }
+
+    // by source-destination distance in hops (a single class
+    // unless the topology is a mesh)
+    m_dist_latency_p50
+        .init(getNumDistClasses())
+        .name(name() + ".packet_latency_dist_p50")
+        .flags(Stats::nozero | Stats::oneline)
+        ;
+    m_dist_latency_p99
+        .init(getNumDistClasses())
+        .name(name() + ".packet_latency_dist_p99")
+        .flags(Stats::nozero | Stats::oneline)
+        ;
+    m_dist_latency_p999
+        .init(getNumDistClasses())
+        .name(name() + ".packet_latency_dist_p999")
+        .flags(Stats::nozero | Stats::oneline)
+        ;
+
+    for (int i = 0; i < getNumDistClasses(); i++) {
+        m_dist_latency_p50.subname(i, csprintf("dist-%i", i));
+        m_dist_latency_p99.subname(i, csprintf("dist-%i", i));
+        m_dist_latency_p999.subname(i, csprintf("dist-%i", i));
+    }
+
 
 
     m_packets_injected
@@ -1127,6 +1210,12 @@ GarnetNetwork::regStats()
         .flags(Stats::pdf | Stats::total | Stats::nozero | Stats::oneline)
         ;
 
+    // Flit/Credit pools
+    m_flit_pool_high_water
+        .name(name() + ".flit_pool_high_water");
+    m_credit_pool_high_water
+        .name(name() + ".credit_pool_high_water");
+
     //interSwap related stats
     m_total_swaps
         .name(name() + ".total_swaps");
@@ -1142,6 +1231,8 @@ GarnetNetwork::regStats()
         .name(name() + ".m_total_failed_downstream_empty");
     m_total_failed_upstream_empty
         .name(name() + ".m_total_failed_upstream_empty");
+    m_total_failed_partial_packet
+        .name(name() + ".m_total_failed_partial_packet");
     m_total_failed_downstream_localOutport
         .name(name() + ".m_total_failed_downstream_localOutport");
     m_total_failed_upstream_localOuport
@@ -1174,12 +1265,371 @@ GarnetNetwork::collateStats()
         }
     }
 
+    m_flit_pool_high_water = m_flit_pool.getHighWaterMark();
+    m_credit_pool_high_water = m_credit_pool.getHighWaterMark();
+
+    m_max_flit_latency = m_flit_latency_rec.max();
+    m_max_flit_network_latency = m_flit_network_latency_rec.max();
+    m_max_flit_queueing_latency = m_flit_queueing_latency_rec.max();
+    m_min_flit_latency = m_flit_latency_rec.min();
+    m_min_flit_network_latency = m_flit_network_latency_rec.min();
+    m_min_flit_queueing_latency = m_flit_queueing_latency_rec.min();
+
+    recorderToHistogram(m_flit_latency_rec, m_flt_latency_hist);
+    recorderToHistogram(m_flit_network_latency_rec,
+                        m_flt_network_latency_hist);
+    recorderToHistogram(m_flit_queueing_latency_rec,
+                        m_flt_queueing_latency_hist);
+
+    // 5-cycle buckets, the last one collects everything from 100 up;
+    // the recorder is exact in that range
+    m_network_latency_histogram.reset();
+    for (int i = 0; i < m_flit_network_latency_rec.numBuckets(); i++) {
+        uint64_t count = m_flit_network_latency_rec.bucketCount(i);
+        if (count == 0)
+            continue;
+        uint64_t index = LatencyRecorder::bucketLow(i) / 5;
+        m_network_latency_histogram[std::min(index, (uint64_t) 20)] += count;
+    }
+
+    for (int i = 0; i < m_virtual_networks; i++) {
+        m_packet_latency_p50[i] = m_packet_latency_rec[i].percentile(0.5);
+        m_packet_latency_p99[i] = m_packet_latency_rec[i].percentile(0.99);
+        m_packet_latency_p999[i] =
+            m_packet_latency_rec[i].percentile(0.999);
+    }
+    for (int i = 0; i < m_dist_latency_rec.size(); i++) {
+        m_dist_latency_p50[i] = m_dist_latency_rec[i].percentile(0.5);
+        m_dist_latency_p99[i] = m_dist_latency_rec[i].percentile(0.99);
+        m_dist_latency_p999[i] = m_dist_latency_rec[i].percentile(0.999);
+    }
+
     // Ask the routers to collate their statistics
     for (int i = 0; i < m_routers.size(); i++) {
         m_routers[i]->collateStats();
     }
 }
 
+/*
+ * Partitions are the distinct event queues the config put the routers
+ * on. An NI runs with its router; a flit link runs with the side that
+ * sends on it and its credit link with the side that receives, so that
+ * a link is only ever woken from its own thread. Links whose two ends
+ * are in different partitions deliver through their mailbox.
+ */
+void
+GarnetNetwork::initPartitions()
+{
+    vector<EventQueue *> queues;
+    m_router_partition.resize(m_routers.size());
+    for (int i = 0; i < m_routers.size(); i++) {
+        EventQueue *queue = m_routers[i]->eventQueue();
+        auto it = std::find(queues.begin(), queues.end(), queue);
+        m_router_partition[i] = it - queues.begin();
+        if (it == queues.end())
+            queues.push_back(queue);
+    }
+    m_num_partitions = queues.size();
+    if (!isPartitioned())
+        return;
+
+    // these read the free-VC count of the neighbour's input unit,
+    // which may be running on another thread
+    fatal_if(m_routing_algorithm == ADAPT_RAND_ ||
+             m_routing_algorithm == ADAPT_WestFirst_,
+             "adaptive random and adaptive west-first routing read "
+             "neighbour routers and cannot be partitioned\n");
+
+    for (int i = 0; i < m_nis.size(); i++) {
+        Router *router = m_routers[m_nis[i]->get_router_id()];
+        fatal_if(m_nis[i]->eventQueue() != router->eventQueue(),
+                 "%s must be on the event queue of %s\n",
+                 m_nis[i]->name(), router->name());
+    }
+
+    Tick min_latency = MaxTick;
+    for (int i = 0; i < m_networklinks.size(); i++) {
+        // an NI end counts as its router
+        const TelemetryLinkInfo &info = m_link_info[i];
+        int src = (info.src_router >= 0) ? info.src_router : info.dest_router;
+        int dest = (info.dest_router >= 0) ? info.dest_router
+                                           : info.src_router;
+        EventQueue *src_queue = m_routers[src]->eventQueue();
+        EventQueue *dest_queue = m_routers[dest]->eventQueue();
+
+        NetworkLink *net_link = m_networklinks[i];
+        CreditLink *credit_link = m_creditlinks[i];
+        fatal_if(net_link->eventQueue() != src_queue,
+                 "%s must be on the event queue of %s\n",
+                 net_link->name(), m_routers[src]->name());
+        fatal_if(credit_link->eventQueue() != dest_queue,
+                 "%s must be on the event queue of %s\n",
+                 credit_link->name(), m_routers[dest]->name());
+
+        if (src_queue != dest_queue) {
+            net_link->setRemoteConsumer();
+            credit_link->setRemoteConsumer();
+            m_remote_links.push_back(net_link);
+            m_remote_links.push_back(credit_link);
+            min_latency = min(min_latency, min(
+                net_link->cyclesToTicks(net_link->get_latency()),
+                credit_link->cyclesToTicks(credit_link->get_latency())));
+        }
+    }
+    if (m_remote_links.empty())
+        min_latency = clockPeriod();
+
+    // A flit sent across a boundary is handed over at the end of the
+    // quantum it was sent in; with a quantum no longer than the link
+    // it is still on time.
+    if (simQuantum == 0) {
+        simQuantum = min_latency;
+    } else if (simQuantum > min_latency) {
+        warn("sim_quantum (%d) exceeds the shortest link between "
+             "partitions (%d ticks): flits crossing partitions will "
+             "arrive late\n", simQuantum, min_latency);
+    }
+
+    m_deferred_swaps.resize(m_num_partitions);
+    m_flit_pool.setThreadSafe(true);
+    m_credit_pool.setThreadSafe(true);
+    m_partition_sync =
+        new PartitionSyncEvent(this, curTick() + simQuantum, simQuantum);
+
+    inform("garnet2.0: %d partitions, %d links between them, "
+           "quantum %d ticks\n", m_num_partitions,
+           m_remote_links.size() / 2, simQuantum);
+}
+
+void
+GarnetNetwork::scheduleNetworkEvent(Event &event, Tick when)
+{
+    if (isPartitioned())
+        m_deferred_events.push_back(make_pair(&event, when));
+    else
+        schedule(event, when);
+}
+
+void
+GarnetNetwork::rescheduleNetworkEvent(Event &event, Tick when)
+{
+    if (isPartitioned()) {
+        for (auto &deferred : m_deferred_events) {
+            if (deferred.first == &event) {
+                deferred.second = when;
+                return;
+            }
+        }
+        // not pending (any more): schedule it, as reschedule() does
+        m_deferred_events.push_back(make_pair(&event, when));
+    } else {
+        reschedule(event, when, true);
+    }
+}
+
+/*
+ * Runs at every quantum boundary while all the other threads wait at
+ * the barrier, so the network can be updated as a whole and events
+ * for any partition can go straight into its queue.
+ */
+void
+GarnetNetwork::partitionSync()
+{
+    inParallelMode = false;
+
+    for (auto link : m_remote_links)
+        link->deliverMailbox();
+
+    // in router order, so that the outcome does not depend on which
+    // thread asked first
+    vector<int> swaps;
+    for (auto &partition_swaps : m_deferred_swaps) {
+        swaps.insert(swaps.end(), partition_swaps.begin(),
+                     partition_swaps.end());
+        partition_swaps.clear();
+    }
+    sort(swaps.begin(), swaps.end());
+    swaps.erase(unique(swaps.begin(), swaps.end()), swaps.end());
+    for (int router_id : swaps) {
+        Router *router = m_routers[router_id];
+        // its packet may have left through the switch in the meantime
+        if (router->swap_ptr.valid)
+            router->initiateSwap();
+    }
+
+    vector<pair<Event *, Tick> > due;
+    for (auto it = m_deferred_events.begin();
+         it != m_deferred_events.end(); ) {
+        if (it->second <= curTick()) {
+            due.push_back(*it);
+            it = m_deferred_events.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto &event : due)
+        event.first->process();
+
+    inParallelMode = true;
+}
+
+// The measurement window has closed: exit once every packet created
+// inside it has been ejected. Messages still waiting in an NI's
+// protocol buffer have not been counted yet, so wait for those too.
+void
+GarnetNetwork::checkDrained()
+{
+    bool drained = (m_measured_in_flight == 0);
+    for (int i = 0; drained && i < m_nis.size(); i++) {
+        if (m_nis[i]->hasPendingMessages())
+            drained = false;
+    }
+
+    if (drained)
+        exitSimLoop("all measured packets drained");
+    else
+        scheduleNetworkEvent(m_drain_event, clockEdge(Cycles(1)));
+}
+
+// One record per router and one per link for the epoch that ends now.
+// Link counts are deltas of the links' utilization counters, which
+// restart from zero when the stats are reset.
+void
+GarnetNetwork::sampleTelemetry()
+{
+    vector<TelemetryRouterRecord> router_recs(m_routers.size());
+    for (int i = 0; i < m_routers.size(); i++)
+        m_routers[i]->sampleTelemetry(router_recs[i]);
+
+    vector<TelemetryLinkRecord> link_recs(m_networklinks.size());
+    for (int i = 0; i < m_networklinks.size(); i++) {
+        unsigned int utilized = m_networklinks[i]->getLinkUtilization();
+        unsigned int last = m_telemetry_link_last[i];
+        link_recs[i].cycle = curCycle();
+        link_recs[i].link = i;
+        link_recs[i].flits = (utilized >= last) ? utilized - last : utilized;
+        m_telemetry_link_last[i] = utilized;
+    }
+
+    ostream *os = m_telemetry_out->stream();
+    os->write((const char *) router_recs.data(),
+              router_recs.size() * sizeof(TelemetryRouterRecord));
+    os->write((const char *) link_recs.data(),
+              link_recs.size() * sizeof(TelemetryLinkRecord));
+    os->flush();
+
+    scheduleNetworkEvent(m_telemetry_event,
+                         clockEdge(Cycles(m_telemetry_period)));
+}
+
+double
+GarnetNetwork::getAvgPacketLatency()
+{
+    double received = m_packets_received.total();
+    if (received == 0)
+        return 0;
+
+    return (m_packet_network_latency.total() +
+            m_packet_queueing_latency.total()) / received;
+}
+
+uint64_t
+GarnetNetwork::getPacketsReceived()
+{
+    return (uint64_t) m_packets_received.total();
+}
+
+// Called from python between simulate() calls. Measured packets of
+// an earlier window that have not drained yet keep counting in
+// m_measured_in_flight, so the new window waits for them too.
+void
+GarnetNetwork::setMeasurementWindow(uint64_t warmup, uint64_t measure)
+{
+    fatal_if(measure == 0, "empty measurement window\n");
+    m_warmup_cycles = curTick() + warmup;
+    m_measure_cycles = measure;
+    rescheduleNetworkEvent(m_drain_event, m_warmup_cycles + m_measure_cycles);
+}
+
+// Called from python between simulate() calls, so with every
+// partition stopped. Wakeups already scheduled for the dropped flits
+// find empty buffers and do nothing.
+void
+GarnetNetwork::resetNetwork()
+{
+    for (auto router : m_routers)
+        router->resetState();
+    for (auto ni : m_nis)
+        ni->resetState();
+    for (auto link : m_networklinks)
+        link->resetState();
+    for (auto link : m_creditlinks)
+        link->resetState();
+
+    for (auto &partition_swaps : m_deferred_swaps)
+        partition_swaps.clear();
+    m_measured_in_flight = 0;
+    m_swap_epoch = curCycle();
+
+    assert(m_flit_pool.getInUse() == 0);
+    assert(m_credit_pool.getInUse() == 0);
+}
+
+void
+GarnetNetwork::setWhenToSwap(uint32_t when_to_swap)
+{
+    fatal_if(!m_interswap, "whenToSwap needs interswap enabled\n");
+    fatal_if(when_to_swap == 0 || when_to_swap > ADAPTIVE_,
+             "Unknown whenToSwap %d\n", when_to_swap);
+    m_whenToSwap = when_to_swap;
+}
+
+void
+GarnetNetwork::recorderToHistogram(const LatencyRecorder &rec,
+                                   Stats::Histogram &hist)
+{
+    hist.reset();
+    for (int i = 0; i < rec.numBuckets(); i++) {
+        if (rec.bucketCount(i) > 0)
+            hist.sample(LatencyRecorder::bucketLow(i), rec.bucketCount(i));
+    }
+}
+
+void
+GarnetNetwork::resetStats()
+{
+    Network::resetStats();
+
+    m_flit_latency_rec.reset();
+    m_flit_network_latency_rec.reset();
+    m_flit_queueing_latency_rec.reset();
+    for (auto &rec : m_packet_latency_rec)
+        rec.reset();
+    for (auto &rec : m_dist_latency_rec)
+        rec.reset();
+}
+
+int
+GarnetNetwork::getNumDistClasses()
+{
+    if (m_num_rows > 0)
+        return m_num_rows + m_num_cols - 1;
+    return 1;
+}
+
+int
+GarnetNetwork::get_router_distance(int src_router, int dest_router)
+{
+    if (m_num_rows <= 0)
+        return 0;
+
+    int src_x = src_router % m_num_cols;
+    int src_y = src_router / m_num_cols;
+    int dest_x = dest_router % m_num_cols;
+    int dest_y = dest_router / m_num_cols;
+    return abs(src_x - dest_x) + abs(src_y - dest_y);
+}
+
 void
 GarnetNetwork::print(ostream& out) const
 {
@@ -1212,3 +1662,31 @@ GarnetNetwork::functionalWrite(Packet *pkt)
     return num_functional_writes;
 }
 
+void
+GarnetNetwork::serialize(CheckpointOut &cp) const
+{
+    SERIALIZE_SCALAR(m_next_packet_id);
+    SERIALIZE_SCALAR(m_measured_in_flight);
+    SERIALIZE_SCALAR(m_total_packets_received);
+}
+
+void
+GarnetNetwork::unserialize(CheckpointIn &cp)
+{
+    UNSERIALIZE_SCALAR(m_next_packet_id);
+    UNSERIALIZE_SCALAR(m_measured_in_flight);
+    UNSERIALIZE_SCALAR(m_total_packets_received);
+
+    // init() scheduled the network's own events counting from tick 0;
+    // the measurement window stays in absolute ticks.
+    if (m_measure_cycles > 0) {
+        rescheduleNetworkEvent(m_drain_event,
+            max<Tick>(m_warmup_cycles + m_measure_cycles, clockEdge()));
+    }
+    if (m_telemetry_period > 0) {
+        rescheduleNetworkEvent(m_telemetry_event,
+                               clockEdge(Cycles(m_telemetry_period)));
+    }
+    if (m_partition_sync)
+        m_partition_sync->reschedule(curTick() + simQuantum);
+}
@@ -35,13 +35,24 @@
 #define __MEM_RUBY_NETWORK_GARNET_NETWORK_HH__
 
 #include <iostream>
+#include <mutex>
+#include <string>
+#include <utility>
 #include <vector>
 
+#include "base/output.hh"
 #include "mem/ruby/network/Network.hh"
 #include "mem/ruby/network/garnet2.0/flit.hh"
 #include "mem/ruby/network/fault_model/FaultModel.hh"
 #include "mem/ruby/network/garnet2.0/CommonTypes.hh"
+#include "mem/ruby/network/garnet2.0/Credit.hh"
+#include "mem/ruby/network/garnet2.0/FlitTrace.hh"
+#include "mem/ruby/network/garnet2.0/LatencyRecorder.hh"
+#include "mem/ruby/network/garnet2.0/Telemetry.hh"
+#include "mem/ruby/network/garnet2.0/flitPool.hh"
 #include "params/GarnetNetwork.hh"
+#include "sim/eventq.hh"
+#include "sim/global_event.hh"
 
 
 class FaultModel;
@@ -72,6 +83,11 @@ class GarnetNetwork : public Network
     uint32_t getBuffersPerDataVC() { return m_buffers_per_data_vc; }
     uint32_t getBuffersPerCtrlVC() { return m_buffers_per_ctrl_vc; }
     int getRoutingAlgorithm() const { return m_routing_algorithm; }
+    // CONGESTION_ routing (see OutputUnit::get_congestion())
+    Cycles getCongestionDelay() const { return m_congestion_delay; }
+    bool isCongestionRegional() const { return m_congestion_regional; }
+    // see Router::get_rng()
+    uint32_t getRandomSeed() const { return m_random_seed; }
 
 	// interSwap congfig.
 	bool isEnableInterswap() const { return m_interswap; }
@@ -79,6 +95,8 @@ class GarnetNetwork : public Network
     void scanNetwork(void);
 
     bool isFaultModelEnabled() const { return m_enable_fault_model; }
+    bool isBitmaskSwAlloc() const { return m_bitmask_sw_alloc; }
+    bool isMultiFlit() const { return m_multi_flit; }
     FaultModel* fault_model;
 
 
@@ -93,9 +111,75 @@ class GarnetNetwork : public Network
     int getNumRouters();
     int get_router_id(int ni);
 
+    // Flit trace hook; a no-op unless flit_trace is set
+    void
+    traceFlit(FlitTraceEvent event, flit *t_flit, int location, int port)
+    {
+        if (m_flit_trace) {
+            std::unique_lock<std::mutex> lock = lockShared();
+            m_flit_trace->record(event, t_flit->get_packet_id(),
+                                 t_flit->get_id(), location, port,
+                                 t_flit->get_vc());
+        }
+    }
+    uint64_t getNextPacketId() { return m_next_packet_id++; }
+
+    // Recycled flit/credit storage shared by all NIs and routers
+    flitPool<flit>& getFlitPool() { return m_flit_pool; }
+    flitPool<Credit>& getCreditPool() { return m_credit_pool; }
+
+    // number of colours used to keep neighbours from initiating
+    // swaps in the same cycle (see colourRouters())
+    int getNumSwapColours() { return m_num_swap_colours; }
+    // TDM turns and swap colours count from the last resetNetwork(),
+    // so every batch point starts on the same swap slot
+    Cycles getSwapEpoch() { return m_swap_epoch; }
+
+    // Partitioned simulation: the config spreads the routers, with
+    // their NIs and controllers, over several event queues (one host
+    // thread each) through their eventq_index. Links between
+    // partitions hand flits over at quantum boundaries, and swaps,
+    // which reach into neighbouring routers, are run there too.
+    bool isPartitioned() const { return m_num_partitions > 1; }
+    int getNumPartitions() const { return m_num_partitions; }
+    void deferSwap(int router_id)
+    {
+        m_deferred_swaps[m_router_partition[router_id]].push_back(router_id);
+    }
+    void partitionSync();
+    // Held by the NIs and routers while they update network-wide
+    // counters; empty (and free) unless the network is partitioned
+    std::unique_lock<std::mutex>
+    lockShared()
+    {
+        if (isPartitioned())
+            return std::unique_lock<std::mutex>(m_shared_mutex);
+        return std::unique_lock<std::mutex>();
+    }
 
-    int get_upstreamId(PortDirection outport_dir, int upstream_id);
-    Router* get_upstreamrouter(PortDirection outport_dir, int upstream_id);
+    // Exported to python for the saturation sweep of the synthetic
+    // tester: packet latency and count since the last stats reset,
+    // and the number of packets ever received (not reset with stats)
+    double getAvgPacketLatency();
+    uint64_t getPacketsReceived();
+    uint64_t getTotalPacketsReceived() { return m_total_packets_received; }
+    // Open a new measurement window (see isMeasured()) that starts
+    // warmup ticks from now; the simulation exits as in a
+    // measure_cycles run once the packets labelled in it have drained
+    void setMeasurementWindow(uint64_t warmup, uint64_t measure);
+
+    // Exported to python for batch runs that share one elaborated
+    // network across parameter points: resetNetwork() drops every
+    // flit and credit in flight, and the messages queued at the NIs,
+    // and returns routers, NIs and links to their state after init();
+    // the swap knobs that are read every cycle can change between
+    // points. Routing and VCs cannot.
+    void resetNetwork();
+    void setWhenToSwap(uint32_t when_to_swap);
+    void setOccupancySwap(uint32_t occupancy_swap)
+    { m_occupancy_swap = occupancy_swap; }
+    void setSwapStallThreshold(uint32_t threshold)
+    { m_swap_stall_threshold = Cycles(threshold); }
 
 
     // Methods used by Topology to setup the network
@@ -112,61 +196,70 @@ class GarnetNetwork : public Network
     //! indicates the number of messages that were written.
     uint32_t functionalWrite(Packet *pkt);
 
+    // Checkpointing of the in-flight network state. Routers, NIs and
+    // links save their own flits; the network keeps the packet
+    // counters. Flits are restored without their protocol message and
+    // are retired at their destination NI, so a congested network can
+    // be checkpointed once and restored with other swap settings.
+    void serialize(CheckpointOut &cp) const override;
+    void unserialize(CheckpointIn &cp) override;
+
     // Stats
     void collateStats();
     void regStats();
+    void resetStats();
     void print(std::ostream& out) const;
 
     // increment counters
 
 
+    // Latency samples go to LatencyRecorders; the histogram, min/max
+    // and percentile stats are filled from them in collateStats()
     void update_flit_latency_histogram(Cycles& latency, int vnet) {
-
-        m_flt_latency_hist.sample(latency);
-        if(latency > max_flit_latency)
-            max_flit_latency = latency;
-        if (latency < min_flit_latency) {
-            min_flit_latency = latency;
-        }
-
+        m_flit_latency_rec.sample(latency);
     }
 
     void update_flit_network_latency_histogram(Cycles& latency, int vnet) {
-
-        m_flt_network_latency_hist.sample(latency);
-        if(latency > max_flit_network_latency)
-            max_flit_network_latency = latency;
-        if (latency < min_flit_network_latency) {
-            min_flit_network_latency = latency;
-        }
-
+        m_flit_network_latency_rec.sample(latency);
     }
 
     void update_flit_queueing_latency_histogram(Cycles& latency, int vnet) {
-
-        m_flt_queueing_latency_hist.sample(latency);
-        if(latency > max_flit_queueing_latency)
-            max_flit_queueing_latency = latency;
-        if (latency < min_flit_queueing_latency) {
-            min_flit_queueing_latency = latency;
-        }
-
+        m_flit_queueing_latency_rec.sample(latency);
     }
 
-    void update_network_latency_histogram(Cycles latency) {
-            uint64_t lat_ = uint64_t(latency);
-            int index = lat_/5;
-            if(index < 20){
-                m_network_latency_histogram[index]++;
-            } else {
-                m_network_latency_histogram[20]++;
-            }
+    void
+    update_packet_latency_histogram(Cycles latency, int vnet,
+                                    int src_router, int dest_router)
+    {
+        m_packet_latency_rec[vnet].sample(latency);
+        m_dist_latency_rec[get_router_distance(src_router, dest_router)]
+            .sample(latency);
     }
 
 
     void increment_injected_packets(int vnet) { m_packets_injected[vnet]++; }
     void increment_received_packets(int vnet) { m_packets_received[vnet]++; }
 
+    // Measurement window: packets created inside it are labelled
+    // at injection and are the only ones counted in the stats
+    bool
+    isMeasured(Tick msg_time)
+    {
+        return (m_measure_cycles == 0 ||
+                (msg_time >= m_warmup_cycles &&
+                 msg_time < m_warmup_cycles + m_measure_cycles));
+    }
+    void increment_measured_in_flight() { m_measured_in_flight++; }
+    void
+    packet_ejected(bool measured)
+    {
+        m_total_packets_received++;
+        if (measured) {
+            assert(m_measured_in_flight > 0);
+            m_measured_in_flight--;
+        }
+    }
+
     void
     increment_packet_network_latency(Cycles latency, int vnet)
     {
@@ -180,19 +273,7 @@ class GarnetNetwork : public Network
     }
 
     void increment_injected_flits(int vnet) { m_flits_injected[vnet]++; }
-    void increment_received_flits(int vnet) {
-        m_flits_received[vnet]++;
-
-        // transfer all numbers to stat variable:
-        m_max_flit_latency = max_flit_latency;
-        m_max_flit_network_latency = max_flit_network_latency;
-        m_max_flit_queueing_latency = max_flit_queueing_latency;
-
-        m_min_flit_latency = min_flit_latency;
-        m_min_flit_network_latency = min_flit_network_latency;
-        m_min_flit_queueing_latency = min_flit_queueing_latency;
-
-    }
+    void increment_received_flits(int vnet) { m_flits_received[vnet]++; }
 
 
     void
@@ -220,14 +301,17 @@ class GarnetNetwork : public Network
     }
 
 	// this is used by interSwap to swap the flits
-	flit*
-	doSwap(flit *t_flit, int upstream_id);
+	bool
+	doSwap(const std::vector<flit *>& pkt, int upstream_id,
+	       std::vector<flit *>& swapped_pkt);
 
+    // neighbour of 'upstream_id' on its 'outport', and the inport of
+    // that neighbour the link lands on (from the routers' link tables)
     int
-    get_downstreamId(PortDirection outport_dir, int upstream_id);
+    get_downstreamId(int outport, int upstream_id);
 
-    PortDirection
-    get_downstreamDirn(PortDirection outport_dir);
+    int
+    get_downstreamInport(int outport, int upstream_id);
 
     Router*
     get_downstreamRouter(PortDirection outport_dir, int upstream_id);
@@ -258,6 +342,7 @@ class GarnetNetwork : public Network
     Stats::Scalar m_total_failed_upstream_empty;
     Stats::Scalar m_total_failed_downstream_localOutport;
     Stats::Scalar m_total_failed_upstream_localOuport;
+    Stats::Scalar m_total_failed_partial_packet;
 
     Stats::Scalar total_pre_swap_deadlock;
     Stats::Scalar total_post_swap_deadlock;
@@ -265,17 +350,85 @@ class GarnetNetwork : public Network
     Cycles print_trigger;
 
     uint32_t m_no_is_swap;
+    // cycles the swap_ptr flit has to stay blocked before
+    // chk_deadlck_symptm() looks at its neighbourhood
+    Cycles m_swap_stall_threshold;
     uint32_t m_occupancy_swap;
     uint32_t m_inj_single_vnet;
     uint32_t m_whichToSwap;
+    uint64_t m_total_packets_received;
+
+    Tick m_warmup_cycles;
+    Tick m_measure_cycles;
+    uint64_t m_measured_in_flight;
+    // polls for the end of the drain phase once the window closes
+    EventFunctionWrapper m_drain_event;
+    void checkDrained();
+
+    // periodic telemetry (see Telemetry.hh for the file format)
+    uint32_t m_telemetry_period;
+    std::string m_telemetry_file;
+    OutputStream *m_telemetry_out;
+    std::vector<unsigned int> m_telemetry_link_last;
+    std::vector<TelemetryLinkInfo> m_link_info;
+    EventFunctionWrapper m_telemetry_event;
+    void sampleTelemetry();
+
+    bool m_flit_trace_enabled;
+    std::string m_flit_trace_file;
+    uint32_t m_flit_trace_buffer;
+    FlitTrace *m_flit_trace;
+    uint64_t m_next_packet_id;
+
+    // Runs partitionSync() at every quantum boundary, ahead of the
+    // routers' and NIs' wakeups for that tick so that a flit due at
+    // the boundary is in the link before its consumer evaluates
+    class PartitionSyncEvent : public GlobalSyncEvent
+    {
+      public:
+        PartitionSyncEvent(GarnetNetwork *net, Tick when, Tick quantum)
+            : GlobalSyncEvent(when, quantum, Default_Pri - 1, 0),
+              m_net(net)
+        {}
+
+        void
+        process() override
+        {
+            m_net->partitionSync();
+            GlobalSyncEvent::process();
+        }
 
-    Cycles max_flit_latency;
-    Cycles max_flit_network_latency;
-    Cycles max_flit_queueing_latency;
-
-    Cycles min_flit_latency;
-    Cycles min_flit_network_latency;
-    Cycles min_flit_queueing_latency;
+        const char *description() const override
+        { return "GarnetNetwork partition sync"; }
+
+      private:
+        GarnetNetwork *m_net;
+    };
+
+    int m_num_partitions;
+    std::vector<int> m_router_partition;
+    std::vector<NetworkLink *> m_remote_links;
+    // swaps requested during the current quantum, per partition
+    std::vector<std::vector<int> > m_deferred_swaps;
+    // network-wide events (drain check, telemetry) that read every
+    // router; run from partitionSync() when partitioned
+    std::vector<std::pair<Event *, Tick> > m_deferred_events;
+    PartitionSyncEvent *m_partition_sync;
+    std::mutex m_shared_mutex;
+    void initPartitions();
+    void scheduleNetworkEvent(Event &event, Tick when);
+    void rescheduleNetworkEvent(Event &event, Tick when);
+
+    LatencyRecorder m_flit_latency_rec;
+    LatencyRecorder m_flit_network_latency_rec;
+    LatencyRecorder m_flit_queueing_latency_rec;
+    // packet latency per vnet and per source-destination distance
+    std::vector<LatencyRecorder> m_packet_latency_rec;
+    std::vector<LatencyRecorder> m_dist_latency_rec;
+    int get_router_distance(int src_router, int dest_router);
+    int getNumDistClasses();
+    void recorderToHistogram(const LatencyRecorder &rec,
+                             Stats::Histogram &hist);
 
     Stats::Vector m_flt_dist;
     Stats::Vector m_network_latency_histogram;
@@ -291,6 +444,13 @@ class GarnetNetwork : public Network
     Stats::Histogram m_flt_network_latency_hist;
     Stats::Histogram m_flt_queueing_latency_hist;
 
+    Stats::Vector m_packet_latency_p50;
+    Stats::Vector m_packet_latency_p99;
+    Stats::Vector m_packet_latency_p999;
+    Stats::Vector m_dist_latency_p50;
+    Stats::Vector m_dist_latency_p99;
+    Stats::Vector m_dist_latency_p999;
+
 
     // int probeNetwork(int vc_base);
 
@@ -303,7 +463,14 @@ class GarnetNetwork : public Network
     uint32_t m_buffers_per_ctrl_vc;
     uint32_t m_buffers_per_data_vc;
     int m_routing_algorithm;
+    Cycles m_congestion_delay;
+    bool m_congestion_regional;
+    uint32_t m_random_seed;
     bool m_enable_fault_model;
+    bool m_bitmask_sw_alloc;
+    bool m_multi_flit;
+    int m_num_swap_colours;
+    Cycles m_swap_epoch;
 
 	// don't be lazy make interSwap dataVariable
 	// protected
@@ -342,6 +509,9 @@ class GarnetNetwork : public Network
 
     Stats::Scalar  m_total_hops;
     Stats::Formula m_avg_hops;
+
+    Stats::Scalar m_flit_pool_high_water;
+    Stats::Scalar m_credit_pool_high_water;
     // for detecting deadlock periodically
     double last_probe;
 
@@ -349,11 +519,16 @@ class GarnetNetwork : public Network
     GarnetNetwork(const GarnetNetwork& obj);
     GarnetNetwork& operator=(const GarnetNetwork& obj);
 
+    void colourRouters();
+
     std::vector<VNET_type > m_vnet_type;
     std::vector<Router *> m_routers;   // All Routers in Network
     std::vector<NetworkLink *> m_networklinks; // All flit links in the network
     std::vector<CreditLink *> m_creditlinks; // All credit links in the network
     std::vector<NetworkInterface *> m_nis;   // All NI's in Network
+
+    flitPool<flit> m_flit_pool;
+    flitPool<Credit> m_credit_pool;
 };
 
 inline std::ostream&
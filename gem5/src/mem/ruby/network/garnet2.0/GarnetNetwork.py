@@ -28,6 +28,7 @@
 # Author: Tushar Krishna
 #
 
+from m5.SimObject import *
 from m5.params import *
 from m5.proxy import *
 from Network import RubyNetwork
@@ -37,6 +38,18 @@ from ClockedObject import ClockedObject
 class GarnetNetwork(RubyNetwork):
     type = 'GarnetNetwork'
     cxx_header = "mem/ruby/network/garnet2.0/GarnetNetwork.hh"
+
+    cxx_exports = [
+        PyBindMethod("getAvgPacketLatency"),
+        PyBindMethod("getPacketsReceived"),
+        PyBindMethod("getTotalPacketsReceived"),
+        PyBindMethod("setMeasurementWindow"),
+        PyBindMethod("resetNetwork"),
+        PyBindMethod("setWhenToSwap"),
+        PyBindMethod("setOccupancySwap"),
+        PyBindMethod("setSwapStallThreshold"),
+    ]
+
     num_rows = Param.Int(0, "number of rows if 2D (mesh/torus/..) topology");
     ni_flit_size = Param.UInt32(16, "network interface flit size in bytes")
     vcs_per_vnet = Param.UInt32(4, "virtual channels per virtual network");
@@ -50,11 +63,48 @@ class GarnetNetwork(RubyNetwork):
     buffers_per_data_vc = Param.UInt32(4, "buffers per data virtual channel");
     buffers_per_ctrl_vc = Param.UInt32(1, "buffers per ctrl virtual channel");
     routing_algorithm = Param.Int(0,
-        "0: Weight-based Table, 1: XY, 2: Custom");
+        "0: Weight-based Table, 1: XY, 2: Random, 3: Adaptive Random, "\
+        "4: West-First, 5: Adaptive West-First, 7: Custom, "\
+        "8: Congestion-aware adaptive");
+    congestion_delay = Param.UInt32(2,
+        "cycles a neighbour's congestion estimate, which arrives on the "\
+        "credits, waits before congestion-aware routing uses it")
+    congestion_regional = Param.Bool(True,
+        "congestion-aware routing adds the regional estimate to the "\
+        "local credit count; otherwise it selects on local credits "\
+        "only (DyXY)")
+    random_seed = Param.UInt32(1,
+        "seed of the per-router random streams used by the random and "\
+        "adaptive routing algorithms; each router's stream is derived "\
+        "from it and the router id")
     enable_fault_model = Param.Bool(False, "enable network fault model");
+    bitmask_sw_alloc = Param.Bool(False,
+        "use the bitmask-based switch allocator (same grants, faster "\
+        "for high-radix routers)");
+    multi_flit = Param.Bool(False,
+        "split packets into ni_flit_size flits (wormhole); otherwise "\
+        "every packet is a single wide flit");
     fault_model = Param.FaultModel(NULL, "network fault model");
+    telemetry_period = Param.UInt32(0,
+        "cycles between per-router/per-link telemetry samples; 0 disables")
+    telemetry_file = Param.String("garnet_telemetry.bin",
+        "telemetry output file in the output directory")
+    flit_trace = Param.Bool(False, "trace flit lifecycle events")
+    flit_trace_file = Param.String("garnet_flit_trace.bin",
+        "flit trace output file in the output directory")
+    flit_trace_buffer = Param.UInt32(1 << 16,
+        "flit trace records buffered before the simulator has to wait "\
+        "for the writer thread")
+    warmup_cycles = Param.UInt64(0,
+        "packets created before this tick are not measured")
+    measure_cycles = Param.UInt64(0,
+        "length of the measurement window after warm-up; 0 measures "\
+        "every packet. Simulation exits once the measured packets drain")
     garnet_deadlock_threshold = Param.UInt32(50000,
                               "network-level deadlock threshold")
+    swap_stall_threshold = Param.UInt32(Parent.swap_stall_threshold,
+                "cycles the swap_ptr flit must stay blocked before its "\
+                "router checks for a deadlock symptom")
     no_is_swap = Param.UInt32(Parent.no_is_swap,
                 "When set is_swap bit will not have any effect.")
     occupancy_swap = Param.UInt32(Parent.occupancy_swap,
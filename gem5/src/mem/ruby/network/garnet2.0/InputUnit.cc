@@ -33,9 +33,12 @@
 
 #include "mem/ruby/network/garnet2.0/InputUnit.hh"
 
+#include "base/intmath.hh"
 #include "base/stl_helpers.hh"
 #include "debug/RubyNetwork.hh"
 #include "mem/ruby/network/garnet2.0/Credit.hh"
+#include "mem/ruby/network/garnet2.0/FlitCheckpoint.hh"
+#include "mem/ruby/network/garnet2.0/OutputUnit.hh"
 #include "mem/ruby/network/garnet2.0/Router.hh"
 #include "mem/ruby/network/garnet2.0/RoutingUnit.hh"
 
@@ -51,8 +54,12 @@ InputUnit::InputUnit(int id, PortDirection direction, Router *router)
     m_id = id;
     m_direction = direction;
     m_router = router;
+    m_congestion_outport = -1;
     m_num_vcs = m_router->get_num_vcs();
     m_vc_per_vnet = m_router->get_vc_per_vnet();
+    m_active_vcs = 0;
+    fatal_if(m_num_vcs > 64, "InputUnit supports at most 64 VCs, %d asked",
+             m_num_vcs);
 
     m_num_buffer_reads.resize(m_num_vcs/m_vc_per_vnet);
     m_num_buffer_writes.resize(m_num_vcs/m_vc_per_vnet);
@@ -64,6 +71,7 @@ InputUnit::InputUnit(int id, PortDirection direction, Router *router)
     creditQueue = new flitBuffer();
     // Instantiating the virtual channels
     m_vcs.resize(m_num_vcs);
+    m_head_since.resize(m_num_vcs, Cycles(0));
     for (int i=0; i < m_num_vcs; i++) {
         m_vcs[i] = new VirtualChannel(i);
     }
@@ -96,6 +104,8 @@ InputUnit::wakeup()
         // assert(vc < m_vc_per_vnet);
         // assert(vc != -1);
         t_flit->increment_hops(); // for stats
+        m_router->get_net_ptr()->traceFlit(FLIT_LT_, t_flit,
+                                           m_router->get_id(), m_id);
         #if (MY_PRINT)
             cout << "InputUnit::wakeup()--- m_id: " << m_id << endl;
             cout << "InputUnit::wakeup()--- direction: " << m_direction << endl;
@@ -114,6 +124,8 @@ InputUnit::wakeup()
             // Route computation for this vc
             int outport = m_router->route_compute(t_flit->get_route(),
                 m_id, m_direction);
+            m_router->get_net_ptr()->traceFlit(FLIT_RC_, t_flit,
+                                               m_router->get_id(), outport);
 
             // you have computed the outport of this flit.. put it
             // the flit as well
@@ -134,19 +146,24 @@ InputUnit::wakeup()
 
             // Update output port in VC
             // All flits in this packet will use this output port
-            // The output port field in the flit is updated after it wins SA
-            // NOTE: but I have updated it above
-//            grant_outport(vc, outport);
+            grant_outport(vc, outport);
 
         }
         else {
-            assert(0); // we do not come here
+            // BODY/TAIL flits of a multi-flit packet follow their head
             assert(m_vcs[vc]->get_state() == ACTIVE_);
+            int outport = m_vcs[vc]->get_outport();
+            assert(outport != -1);
+            t_flit->set_outport(outport);
+            t_flit->set_outport_dir(m_router->getOutportDirection(outport));
         }
 
 
         // Buffer the flit
+        if (m_vcs[vc]->isEmpty())
+            m_head_since[vc] = m_router->curCycle();
         m_vcs[vc]->insertFlit(t_flit);
+        m_active_vcs |= (1ULL << vc);
 
         int vnet = vc/m_vc_per_vnet;
         // number of writes same as reads
@@ -212,17 +229,17 @@ InputUnit::makeSwapPtrValid(flit* t_flit) {
 
         // NOTE: Causing heavy perf-penatlty
         // we can also make swap_ptr point to Local Port if 'ENABLE_LOCAL_SWAP_' is true
-        if (((this->m_direction == "North") || (this->m_direction == "East") ||
-            (this->m_direction == "West") || (this->m_direction == "South")) &&
-            ((t_flit->get_outport_dir() == "North") ||
-             (t_flit->get_outport_dir() == "East") ||
-             (t_flit->get_outport_dir() == "West") ||
-             (t_flit->get_outport_dir() == "South"))) {
+        PortDirection outport_dirn = t_flit->get_outport_dir();
+        // any inter-router port qualifies; ports of Crossbar/Pt2Pt
+        // topologies have no compass direction (PortDirection_Unknown)
+        if ((m_direction != PortDirection_Local) &&
+            (outport_dirn != PortDirection_Local)) {
             // currently making swap_Ptr randomly valid;
             // in whichever inport dirn
             // flit comes first and taking from there to point to next inport
             // direction in SwitchAllocator stage
-            get_router()->makeSwapPtrValid(this->m_direction, t_flit->get_vc());
+            get_router()->makeSwapPtrValid(m_id, this->m_direction,
+                                           t_flit->get_vc());
             // if you are making swap_ptr valid;
             // also specify direction.
             #if (MY_PRINT)
@@ -241,12 +258,85 @@ InputUnit::makeSwapPtrValid(flit* t_flit) {
 }
 
 
+int
+InputUnit::get_occupancy()
+{
+    int occupancy = 0;
+    for (uint64_t vcs = m_active_vcs; vcs != 0; vcs &= vcs - 1)
+        occupancy += m_vcs[findLsbSet(vcs)]->getSize();
+    return occupancy;
+}
+
+// A packet can only be swapped as a whole: 'vc' must hold every flit
+// of the packet at its head, i.e., the head flit is at the top and the
+// tail has arrived (a vc only ever holds one packet).
+int
+InputUnit::get_packet_size(int vc)
+{
+    if (m_vcs[vc]->isEmpty())
+        return 0;
+
+    flit *t_flit = m_vcs[vc]->peekTopFlit();
+    if ((t_flit->get_type() != HEAD_) && (t_flit->get_type() != HEAD_TAIL_))
+        return 0;
+    if (m_vcs[vc]->getSize() != t_flit->get_size())
+        return 0;
+
+    return t_flit->get_size();
+}
+
+void
+InputUnit::peekPacket(int vc, std::vector<flit *>& pkt)
+{
+    int size = get_packet_size(vc);
+    assert(size > 0);
+    pkt.resize(size);
+    for (int i = 0; i < size; i++)
+        pkt[i] = m_vcs[vc]->peekFlit(i);
+}
+
+void
+InputUnit::popPacket(int vc, std::vector<flit *>& pkt)
+{
+    int size = get_packet_size(vc);
+    assert(size > 0);
+    pkt.resize(size);
+    for (int i = 0; i < size; i++) {
+        pkt[i] = getTopFlit(vc);
+        m_router->get_net_ptr()->traceFlit(FLIT_SWAP_OUT_, pkt[i],
+                                           m_router->get_id(), m_id);
+    }
+}
+
+// Put a whole packet back at the head of an empty-by-now vc, and make
+// all of its flits follow 'outport' out of this router.
+void
+InputUnit::pushPacket(int vc, const std::vector<flit *>& pkt, int outport)
+{
+    assert(m_vcs[vc]->isEmpty());
+    PortDirection outport_dirn = m_router->getOutportDirection(outport);
+    for (int i = pkt.size() - 1; i >= 0; i--) {
+        pkt[i]->set_vc(vc);
+        pkt[i]->set_outport(outport);
+        pkt[i]->set_outport_dir(outport_dirn);
+        enqueue_flit(vc, pkt[i]);
+        m_router->get_net_ptr()->traceFlit(FLIT_SWAP_IN_, pkt[i],
+                                           m_router->get_id(), m_id);
+    }
+    grant_outport(vc, outport);
+}
+
 // Send a credit back to upstream router for this VC.
 // Called by SwitchAllocator when the flit in this VC wins the Switch.
 void
 InputUnit::increment_credit(int in_vc, bool free_signal, Cycles curTime)
 {
-    Credit *t_credit = new Credit(in_vc, free_signal, curTime);
+    Credit *t_credit = m_router->get_net_ptr()->getCreditPool().allocate(
+        in_vc, free_signal, curTime);
+    if (m_congestion_outport != -1) {
+        t_credit->set_congestion(m_router->get_outputUnit_ref()[
+            m_congestion_outport]->get_congestion_estimate());
+    }
     creditQueue->insert(t_credit);
     m_credit_link->scheduleEventAbsolute(m_router->clockEdge(Cycles(1)));
 }
@@ -271,3 +361,81 @@ InputUnit::resetStats()
         m_num_buffer_writes[j] = 0;
     }
 }
+
+void
+InputUnit::resetState()
+{
+    GarnetNetwork *net_ptr = m_router->get_net_ptr();
+    Cycles curTime = m_router->curCycle();
+    for (int vc = 0; vc < m_num_vcs; vc++) {
+        m_vcs[vc]->getBuffer()->clear(net_ptr->getFlitPool());
+        m_vcs[vc]->set_idle(curTime);
+        m_head_since[vc] = curTime;
+    }
+    m_active_vcs = 0;
+    creditQueue->clear(net_ptr->getCreditPool());
+}
+
+void
+InputUnit::serialize(CheckpointOut &cp) const
+{
+    vector<int> vc_state, vc_outport, vc_outvc;
+    vector<uint64_t> vc_state_time, vc_enqueue_time, head_since;
+    for (int vc = 0; vc < m_num_vcs; vc++) {
+        VirtualChannel *t_vc = m_vcs[vc];
+        vc_state.push_back(t_vc->get_state());
+        vc_state_time.push_back(t_vc->get_state_time());
+        vc_outport.push_back(t_vc->get_outport());
+        vc_outvc.push_back(t_vc->get_outvc());
+        vc_enqueue_time.push_back(t_vc->get_enqueue_time());
+        head_since.push_back(m_head_since[vc]);
+        serializeFlitBuffer<flit>(cp, csprintf("vc%d", vc),
+                                  t_vc->getBuffer());
+    }
+    SERIALIZE_CONTAINER(vc_state);
+    SERIALIZE_CONTAINER(vc_state_time);
+    SERIALIZE_CONTAINER(vc_outport);
+    SERIALIZE_CONTAINER(vc_outvc);
+    SERIALIZE_CONTAINER(vc_enqueue_time);
+    SERIALIZE_CONTAINER(head_since);
+
+    serializeFlitBuffer<Credit>(cp, "credit_queue", creditQueue);
+}
+
+void
+InputUnit::unserialize(CheckpointIn &cp)
+{
+    vector<int> vc_state, vc_outport, vc_outvc;
+    vector<uint64_t> vc_state_time, vc_enqueue_time, head_since;
+    UNSERIALIZE_CONTAINER(vc_state);
+    UNSERIALIZE_CONTAINER(vc_state_time);
+    UNSERIALIZE_CONTAINER(vc_outport);
+    UNSERIALIZE_CONTAINER(vc_outvc);
+    UNSERIALIZE_CONTAINER(vc_enqueue_time);
+    UNSERIALIZE_CONTAINER(head_since);
+    fatal_if(vc_state.size() != m_num_vcs,
+             "Checkpoint has %d VCs for inport %d of router %d, "
+             "the network has %d\n", vc_state.size(), m_id,
+             m_router->get_id(), m_num_vcs);
+
+    GarnetNetwork *net_ptr = m_router->get_net_ptr();
+    m_active_vcs = 0;
+    for (int vc = 0; vc < m_num_vcs; vc++) {
+        VirtualChannel *t_vc = m_vcs[vc];
+        t_vc->set_state((VC_state_type) vc_state[vc],
+                        Cycles(vc_state_time[vc]));
+        t_vc->set_outport(vc_outport[vc]);
+        t_vc->set_outvc(vc_outvc[vc]);
+        t_vc->set_enqueue_time(Cycles(vc_enqueue_time[vc]));
+        m_head_since[vc] = Cycles(head_since[vc]);
+        unserializeFlitBuffer(cp, csprintf("vc%d", vc), t_vc->getBuffer(),
+                              net_ptr->getFlitPool());
+        if (!t_vc->isEmpty())
+            m_active_vcs |= (1ULL << vc);
+        scheduleRestoredFlits(m_router, m_router, t_vc->getBuffer());
+    }
+
+    unserializeFlitBuffer(cp, "credit_queue", creditQueue,
+                          net_ptr->getCreditPool());
+    scheduleRestoredFlits(m_credit_link, m_router, creditQueue);
+}
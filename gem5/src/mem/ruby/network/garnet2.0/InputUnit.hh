@@ -44,8 +44,9 @@
 #include "mem/ruby/network/garnet2.0/Router.hh"
 #include "mem/ruby/network/garnet2.0/VirtualChannel.hh"
 #include "mem/ruby/network/garnet2.0/flitBuffer.hh"
+#include "sim/serialize.hh"
 
-class InputUnit : public Consumer
+class InputUnit : public Consumer, public Serializable
 {
   public:
     InputUnit(int id, PortDirection direction, Router *router);
@@ -105,6 +106,13 @@ class InputUnit : public Consumer
     }
 
     void increment_credit(int in_vc, bool free_signal, Cycles curTime);
+    // CONGESTION_ routing: the credits of this inport carry the
+    // congestion estimate of 'outport' (the one straight ahead)
+    void
+    set_congestion_outport(int outport)
+    {
+        m_congestion_outport = outport;
+    }
 
     inline flit*
     peekTopFlit(int vc)
@@ -115,9 +123,28 @@ class InputUnit : public Consumer
     inline flit*
     getTopFlit(int vc)
     {
-        return m_vcs[vc]->getTopFlit();
+        flit *t_flit = m_vcs[vc]->getTopFlit();
+        if (m_vcs[vc]->isEmpty())
+            m_active_vcs &= ~(1ULL << vc);
+        else
+            m_head_since[vc] = m_router->curCycle();
+        return t_flit;
+    }
+
+    // Cycles the head flit of this (non-empty) vc has been waiting
+    // at the head of the queue
+    inline Cycles
+    get_stall_cycles(int vc, Cycles curTime)
+    {
+        assert(!m_vcs[vc]->isEmpty());
+        return curTime - m_head_since[vc];
     }
 
+    // Bitmask of the VCs that hold at least one flit
+    inline uint64_t get_active_vcs() { return m_active_vcs; }
+    // flits buffered in all vcs of this input port
+    int get_occupancy();
+
     inline bool
     need_stage(int vc, flit_stage stage, Cycles time)
     {
@@ -146,6 +173,12 @@ class InputUnit : public Consumer
         m_credit_link = credit_link;
     }
 
+    // SWAP moves whole packets only
+    int get_packet_size(int vc);
+    void peekPacket(int vc, std::vector<flit *>& pkt);
+    void popPacket(int vc, std::vector<flit *>& pkt);
+    void pushPacket(int vc, const std::vector<flit *>& pkt, int outport);
+
     inline bool
     vc_isEmpty(int invc)
     {
@@ -173,6 +206,8 @@ class InputUnit : public Consumer
         // instead of tail; it should insert
         // flit at the head
         m_vcs[vc]->insertFlitAtTop(flit_t);
+        m_active_vcs |= (1ULL << vc);
+        m_head_since[vc] = m_router->curCycle();
         return;
     }
 
@@ -183,6 +218,12 @@ class InputUnit : public Consumer
 
     uint32_t functionalWrite(Packet *pkt);
     void resetStats();
+    // drop all buffered flits and queued credits, VCs go idle
+    void resetState();
+
+    // VCs and queued credits (see Router::serialize())
+    void serialize(CheckpointOut &cp) const override;
+    void unserialize(CheckpointIn &cp) override;
   // Input Virtual channels
   std::vector<VirtualChannel *> m_vcs;
 
@@ -191,8 +232,12 @@ class InputUnit : public Consumer
     PortDirection m_direction;
     int m_num_vcs;
     int m_vc_per_vnet;
+    uint64_t m_active_vcs;
+    // cycle at which the current head flit of each vc got to the head
+    std::vector<Cycles> m_head_since;
 
     Router *m_router;
+    int m_congestion_outport;
     NetworkLink *m_in_link;
     CreditLink *m_credit_link;
     flitBuffer *creditQueue;
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET_LATENCY_RECORDER_HH__
+#define __MEM_RUBY_NETWORK_GARNET_LATENCY_RECORDER_HH__
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "base/intmath.hh"
+
+// Log-linear (HDR style) latency histogram. Values below
+// 2^(SubBucketBits+1) get a bucket each; above that every power of two
+// is split into 2^SubBucketBits buckets, so a bucket is never wider
+// than 1/64th of its value. Recording is an index computation and an
+// increment; percentiles and the gem5 stats are derived from the
+// buckets only when the stats are collated.
+
+class LatencyRecorder
+{
+  public:
+    static const int SubBucketBits = 6;
+
+    LatencyRecorder() { reset(); }
+
+    void
+    sample(uint64_t value)
+    {
+        int idx = index(value);
+        if (idx >= m_buckets.size())
+            m_buckets.resize(idx + 1, 0);
+        m_buckets[idx]++;
+
+        m_count++;
+        if (value < m_min)
+            m_min = value;
+        if (value > m_max)
+            m_max = value;
+    }
+
+    void
+    reset()
+    {
+        m_buckets.clear();
+        m_count = 0;
+        m_min = std::numeric_limits<uint64_t>::max();
+        m_max = 0;
+    }
+
+    uint64_t count() const { return m_count; }
+    uint64_t min() const { return m_count ? m_min : 0; }
+    uint64_t max() const { return m_max; }
+
+    int numBuckets() const { return m_buckets.size(); }
+    uint64_t bucketCount(int idx) const { return m_buckets[idx]; }
+
+    // smallest and largest value that map to bucket 'idx'
+    static uint64_t
+    bucketLow(int idx)
+    {
+        const int sub_buckets = 1 << SubBucketBits;
+        if (idx < 2 * sub_buckets)
+            return idx;
+        int shift = idx / sub_buckets - 1;
+        return (uint64_t)(idx - shift * sub_buckets) << shift;
+    }
+
+    static uint64_t
+    bucketHigh(int idx)
+    {
+        return bucketLow(idx + 1) - 1;
+    }
+
+    // value below which a fraction 'q' of the samples fall; reported
+    // as the top of the bucket, so at most 1/64th above the true value
+    uint64_t
+    percentile(double q) const
+    {
+        if (m_count == 0)
+            return 0;
+
+        uint64_t target = (uint64_t) std::ceil(q * m_count);
+        if (target == 0)
+            target = 1;
+
+        uint64_t seen = 0;
+        for (int i = 0; i < m_buckets.size(); i++) {
+            seen += m_buckets[i];
+            if (seen >= target)
+                return std::min(bucketHigh(i), m_max);
+        }
+        return m_max;
+    }
+
+  private:
+    static int
+    index(uint64_t value)
+    {
+        const uint64_t sub_buckets = 1 << SubBucketBits;
+        if (value < 2 * sub_buckets)
+            return value;
+        int shift = floorLog2(value) - SubBucketBits;
+        return shift * sub_buckets + (value >> shift);
+    }
+
+    std::vector<uint64_t> m_buckets;
+    uint64_t m_count;
+    uint64_t m_min;
+    uint64_t m_max;
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET_LATENCY_RECORDER_HH__
@@ -41,6 +41,7 @@
 #include "debug/RubyNetwork.hh"
 #include "mem/ruby/network/MessageBuffer.hh"
 #include "mem/ruby/network/garnet2.0/Credit.hh"
+#include "mem/ruby/network/garnet2.0/FlitCheckpoint.hh"
 #include "mem/ruby/network/garnet2.0/flitBuffer.hh"
 #include "mem/ruby/slicc_interface/Message.hh"
 
@@ -143,6 +144,16 @@ void
 NetworkInterface::incrementStats(flit *t_flit)
 {
     int vnet = t_flit->get_vnet();
+    bool is_tail =
+        (t_flit->get_type() == TAIL_ || t_flit->get_type() == HEAD_TAIL_);
+    std::unique_lock<std::mutex> stats_lock = m_net_ptr->lockShared();
+
+    if (is_tail)
+        m_net_ptr->packet_ejected(t_flit->is_measured());
+
+    // Packets from outside the measurement window are not counted
+    if (!t_flit->is_measured())
+        return;
 
     // Latency
     m_net_ptr->increment_received_flits(vnet);
@@ -160,17 +171,19 @@ NetworkInterface::incrementStats(flit *t_flit)
     m_net_ptr->update_flit_latency_histogram(total_delay, vnet);
     m_net_ptr->update_flit_network_latency_histogram(network_delay, vnet);
     m_net_ptr->update_flit_queueing_latency_histogram(queueing_delay, vnet);
-    m_net_ptr->update_network_latency_histogram(network_delay);
 
 
-    if (t_flit->get_type() == TAIL_ || t_flit->get_type() == HEAD_TAIL_) {
+    const RouteInfo &route = t_flit->m_route;
+    if (is_tail) {
         m_net_ptr->increment_received_packets(vnet);
         m_net_ptr->increment_packet_network_latency(network_delay, vnet);
         m_net_ptr->increment_packet_queueing_latency(queueing_delay, vnet);
+        m_net_ptr->update_packet_latency_histogram(total_delay, vnet,
+            route.src_router, route.dest_router);
     }
 
     // Hops
-    m_net_ptr->increment_total_hops(t_flit->get_route().hops_traversed);
+    m_net_ptr->increment_total_hops(route.hops_traversed);
 }
 
 /*
@@ -218,12 +231,20 @@ NetworkInterface::wakeup()
     if (inNetLink->isReady(curCycle())) {
         flit *t_flit = inNetLink->consumeLink();
         int vnet = t_flit->get_vnet();
+        m_net_ptr->traceFlit(FLIT_EJECT_, t_flit, m_id, -1);
         t_flit->set_dequeue_time(curCycle());
 
         // If a tail flit is received, enqueue into the protocol buffers if
         // space is available. Otherwise, exchange non-tail flits for credits.
+        // A packet restored from a checkpoint has no protocol message to
+        // deliver; its tail is retired like a non-tail flit, with the VC
+        // free signal.
         if (t_flit->get_type() == TAIL_ || t_flit->get_type() == HEAD_TAIL_) {
-            if (!messageEnqueuedThisCycle &&
+            if (!t_flit->get_msg_ptr()) {
+                sendCredit(t_flit, true);
+                incrementStats(t_flit);
+                m_net_ptr->getFlitPool().release(t_flit);
+            } else if (!messageEnqueuedThisCycle &&
                 outNode_ptr[vnet]->areNSlotsAvailable(1, curTime)) {
                 // Space is available. Enqueue to protocol buffer.
                 outNode_ptr[vnet]->enqueue(t_flit->get_msg_ptr(), curTime,
@@ -233,9 +254,9 @@ NetworkInterface::wakeup()
                 // this flit in the NI
                 sendCredit(t_flit, true);
 
-                // Update stats and delete flit pointer
+                // Update stats and recycle flit pointer
                 incrementStats(t_flit);
-                delete t_flit;
+                m_net_ptr->getFlitPool().release(t_flit);
             } else {
                 // No space available- Place tail flit in stall queue and set
                 // up a callback for when protocol buffer is dequeued. Stat
@@ -250,9 +271,9 @@ NetworkInterface::wakeup()
             // Non-tail flit. Send back a credit but not VC free signal.
             sendCredit(t_flit, false);
 
-            // Update stats and delete flit pointer.
+            // Update stats and recycle flit pointer.
             incrementStats(t_flit);
-            delete t_flit;
+            m_net_ptr->getFlitPool().release(t_flit);
         }
     }
 
@@ -264,7 +285,7 @@ NetworkInterface::wakeup()
         if (t_credit->is_free_signal()) {
             m_out_vc_state[t_credit->get_vc()]->setState(IDLE_, curCycle());
         }
-        delete t_credit;
+        m_net_ptr->getCreditPool().release(t_credit);
     }
 
 
@@ -280,7 +301,8 @@ NetworkInterface::wakeup()
 void
 NetworkInterface::sendCredit(flit *t_flit, bool is_free)
 {
-    Credit *credit_flit = new Credit(t_flit->get_vc(), is_free, curCycle());
+    Credit *credit_flit = m_net_ptr->getCreditPool().allocate(
+        t_flit->get_vc(), is_free, curCycle());
     outCreditQueue->insert(credit_flit);
 }
 
@@ -297,9 +319,15 @@ NetworkInterface::checkStallQueue()
             int vnet = stallFlit->get_vnet();
 
             // If we can now eject to the protocol buffer, send back credits
-            if (outNode_ptr[vnet]->areNSlotsAvailable(1, curTime)) {
-                outNode_ptr[vnet]->enqueue(stallFlit->get_msg_ptr(), curTime,
-                                           cyclesToTicks(Cycles(1)));
+            // (a flit restored from a checkpoint has no message to eject)
+            bool has_msg = (bool) stallFlit->get_msg_ptr();
+            if (!has_msg ||
+                outNode_ptr[vnet]->areNSlotsAvailable(1, curTime)) {
+                if (has_msg) {
+                    outNode_ptr[vnet]->enqueue(stallFlit->get_msg_ptr(),
+                                               curTime,
+                                               cyclesToTicks(Cycles(1)));
+                }
 
                 // Send back a credit with free signal now that the VC is no
                 // longer stalled.
@@ -308,8 +336,8 @@ NetworkInterface::checkStallQueue()
                 // Update Stats
                 incrementStats(stallFlit);
 
-                // Flit can now safely be deleted and removed from stall queue
-                delete stallFlit;
+                // Flit can now safely be recycled and removed from stall queue
+                m_net_ptr->getFlitPool().release(stallFlit);
                 m_stall_queue.erase(stallIter);
                 m_stall_count[vnet]--;
 
@@ -317,6 +345,9 @@ NetworkInterface::checkStallQueue()
                 // callback on it's MessageBuffer is not needed.
                 if (m_stall_count[vnet] == 0)
                     outNode_ptr[vnet]->unregisterDequeueCallback();
+                // and no callback will wake us for the restored ones
+                if (!has_msg && !m_stall_queue.empty())
+                    scheduleEvent(Cycles(1));
 
                 messageEnqueuedThisCycle = true;
                 break;
@@ -344,8 +375,10 @@ NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
     int num_flits = (int) ceil((double) m_net_ptr->MessageSizeType_to_int(
         net_msg_ptr->getMessageSize())/m_net_ptr->getNiFlitSize());
 
-    // HACK - no multi-flit support. Assume wide links and single-flit data packets.
-    num_flits = 1;
+    // Unless multi-flit packets are enabled, assume wide links and
+    // single-flit data packets.
+    if (!m_net_ptr->isMultiFlit())
+        num_flits = 1;
 
     // loop to convert all multicast messages into unicast messages
     for (int ctr = 0; ctr < dest_nodes.size(); ctr++) {
@@ -392,7 +425,6 @@ NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
         // Custom routing algorithms just need destID
         RouteInfo route;
         route.vnet = vnet;
-        route.net_dest = new_net_msg_ptr->getDestination();
         route.src_ni = m_id;
         route.src_router = m_router_id;
         route.dest_ni = destID;
@@ -402,20 +434,30 @@ NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
         // so that the first router increments it to 0
         route.hops_traversed = -1;
 
-        m_net_ptr->increment_injected_packets(vnet);
+        // label the packet by the time the protocol created it
+        std::unique_lock<std::mutex> stats_lock = m_net_ptr->lockShared();
+        bool measured = m_net_ptr->isMeasured(msg_ptr->getTime());
+        uint64_t packet_id = m_net_ptr->getNextPacketId();
+        if (measured) {
+            m_net_ptr->increment_injected_packets(vnet);
+            m_net_ptr->increment_measured_in_flight();
+        }
         for (int i = 0; i < num_flits; i++) {
             //m_net_ptr->increment_injected_flits(vnet);
-            flit *fl = new flit(i, vc, vnet, route, num_flits, new_msg_ptr,
-                curCycle());
+            flit *fl = m_net_ptr->getFlitPool().allocate(i, vc, vnet, route,
+                num_flits, new_msg_ptr, curCycle());
 
             fl->set_src_delay(curCycle() - ticksToCycles(msg_ptr->getTime()));
+            fl->set_measured(measured);
+            fl->set_packet_id(packet_id);
             m_ni_out_vcs[vc]->insert(fl);
         }
 
-        // this is to get the number of (actual) flits injected with ''HACK'
+        // this is to get the number of (actual) flits injected, also
+        // when the packet was sent as a single wide flit
         int packet_size = (int) ceil((double) m_net_ptr->MessageSizeType_to_int(
             net_msg_ptr->getMessageSize())/m_net_ptr->getNiFlitSize());
-        for (int i = 0; i < packet_size; i++) {
+        for (int i = 0; measured && i < packet_size; i++) {
             m_net_ptr->increment_injected_flits(vnet);
         }
 
@@ -500,6 +542,7 @@ NetworkInterface::scheduleOutputLink()
             flit *t_flit = m_ni_out_vcs[vc]->getTopFlit();
             t_flit->set_time(curCycle() + Cycles(1));
             outFlitQueue->insert(t_flit);
+            m_net_ptr->traceFlit(FLIT_INJECT_, t_flit, m_id, -1);
             // schedule the out link
             outNetLink->scheduleEventAbsolute(clockEdge(Cycles(1)));
 
@@ -549,6 +592,16 @@ NetworkInterface::checkReschedule()
     }
 }
 
+bool
+NetworkInterface::hasPendingMessages()
+{
+    for (const auto& it : inNode_ptr) {
+        if (it != nullptr && !it->isEmpty())
+            return true;
+    }
+    return false;
+}
+
 void
 NetworkInterface::print(std::ostream& out) const
 {
@@ -567,6 +620,102 @@ NetworkInterface::functionalWrite(Packet *pkt)
     return num_functional_writes;
 }
 
+void
+NetworkInterface::resetState()
+{
+    for (auto outvc_state : m_out_vc_state)
+        outvc_state->reset(curCycle());
+    std::fill(m_vc_allocator.begin(), m_vc_allocator.end(), 0);
+    m_vc_round_robin = 0;
+    std::fill(vc_busy_counter.begin(), vc_busy_counter.end(), 0);
+
+    for (int vc = 0; vc < m_num_vcs; vc++) {
+        m_ni_out_vcs[vc]->clear(m_net_ptr->getFlitPool());
+        m_ni_out_vcs_enqueue_time[vc] = Cycles(INFINITE_);
+    }
+    outFlitQueue->clear(m_net_ptr->getFlitPool());
+    outCreditQueue->clear(m_net_ptr->getCreditPool());
+
+    for (auto t_flit : m_stall_queue)
+        m_net_ptr->getFlitPool().release(t_flit);
+    m_stall_queue.clear();
+    for (int vnet = 0; vnet < m_virtual_networks; vnet++) {
+        if (m_stall_count[vnet] > 0)
+            outNode_ptr[vnet]->unregisterDequeueCallback();
+        m_stall_count[vnet] = 0;
+    }
+
+    // messages the protocol queued for the network, or not yet
+    // consumed from it
+    for (auto buffer : inNode_ptr) {
+        if (buffer != nullptr)
+            buffer->clear();
+    }
+    for (auto buffer : outNode_ptr) {
+        if (buffer != nullptr)
+            buffer->clear();
+    }
+}
+
+void
+NetworkInterface::serialize(CheckpointOut &cp) const
+{
+    serializeOutVcStates(cp, "outvc", m_out_vc_state);
+    SERIALIZE_CONTAINER(m_vc_allocator);
+    SERIALIZE_SCALAR(m_vc_round_robin);
+    SERIALIZE_CONTAINER(vc_busy_counter);
+
+    vector<uint64_t> ni_out_vcs_enqueue_time;
+    for (int vc = 0; vc < m_num_vcs; vc++) {
+        ni_out_vcs_enqueue_time.push_back(m_ni_out_vcs_enqueue_time[vc]);
+        serializeFlitBuffer<flit>(cp, csprintf("ni_out_vc%d", vc),
+                                  m_ni_out_vcs[vc]);
+    }
+    SERIALIZE_CONTAINER(ni_out_vcs_enqueue_time);
+
+    serializeFlitBuffer<flit>(cp, "out_flit_queue", outFlitQueue);
+    serializeFlitBuffer<Credit>(cp, "out_credit_queue", outCreditQueue);
+    serializeFlits<flit>(cp, "stall_queue", m_stall_queue);
+}
+
+void
+NetworkInterface::unserialize(CheckpointIn &cp)
+{
+    unserializeOutVcStates(cp, "outvc", m_out_vc_state);
+    UNSERIALIZE_CONTAINER(m_vc_allocator);
+    UNSERIALIZE_SCALAR(m_vc_round_robin);
+    UNSERIALIZE_CONTAINER(vc_busy_counter);
+
+    vector<uint64_t> ni_out_vcs_enqueue_time;
+    UNSERIALIZE_CONTAINER(ni_out_vcs_enqueue_time);
+    fatal_if(ni_out_vcs_enqueue_time.size() != m_num_vcs,
+             "Checkpoint has %d VCs for %s, the network has %d\n",
+             ni_out_vcs_enqueue_time.size(), name(), m_num_vcs);
+    for (int vc = 0; vc < m_num_vcs; vc++) {
+        m_ni_out_vcs_enqueue_time[vc] = Cycles(ni_out_vcs_enqueue_time[vc]);
+        unserializeFlitBuffer(cp, csprintf("ni_out_vc%d", vc),
+                              m_ni_out_vcs[vc], m_net_ptr->getFlitPool());
+        scheduleRestoredFlits(this, this, m_ni_out_vcs[vc]);
+    }
+
+    unserializeFlitBuffer(cp, "out_flit_queue", outFlitQueue,
+                          m_net_ptr->getFlitPool());
+    scheduleRestoredFlits(outNetLink, this, outFlitQueue);
+    unserializeFlitBuffer(cp, "out_credit_queue", outCreditQueue,
+                          m_net_ptr->getCreditPool());
+    scheduleRestoredFlits(outCreditLink, this, outCreditQueue);
+
+    // The stalled tails lost their protocol message with the rest of
+    // the checkpoint; checkStallQueue() retires them in the next cycle.
+    for (auto t_flit : unserializeFlits(cp, "stall_queue",
+                                        m_net_ptr->getFlitPool())) {
+        m_stall_queue.push_back(t_flit);
+        m_stall_count[t_flit->get_vnet()]++;
+    }
+    if (!m_stall_queue.empty())
+        scheduleEventAbsolute(clockEdge(Cycles(1)));
+}
+
 NetworkInterface *
 GarnetNetworkInterfaceParams::create()
 {
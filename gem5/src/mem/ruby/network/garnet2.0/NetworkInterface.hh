@@ -71,9 +71,22 @@ class NetworkInterface : public ClockedObject, public Consumer
     int get_vnet(int vc);
     int get_router_id() { return m_router_id; }
     void init_net_ptr(GarnetNetwork *net_ptr) { m_net_ptr = net_ptr; }
+    // true while a protocol message waits to be flitisized
+    bool hasPendingMessages();
 
     uint32_t functionalWrite(Packet *);
 
+    // Drop the flits and credits queued in the NI and free every VC
+    // (see GarnetNetwork::resetNetwork()). Messages queued in the
+    // protocol buffers, in either direction, are discarded too.
+    void resetState();
+
+    // Checkpointing of the flits and credits queued in the NI and of
+    // its VC state. Messages still in the protocol buffers are not
+    // part of the network state.
+    void serialize(CheckpointOut &cp) const override;
+    void unserialize(CheckpointIn &cp) override;
+
   private:
     GarnetNetwork *m_net_ptr;
     const NodeID m_id;
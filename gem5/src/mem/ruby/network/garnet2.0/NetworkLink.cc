@@ -32,16 +32,20 @@
 
 
 #include "mem/ruby/network/garnet2.0/NetworkLink.hh"
+
 #include "mem/ruby/network/garnet2.0/CreditLink.hh"
+#include "mem/ruby/network/garnet2.0/FlitCheckpoint.hh"
+#include "mem/ruby/network/garnet2.0/GarnetNetwork.hh"
 
 NetworkLink::NetworkLink(const Params *p)
     : ClockedObject(p), Consumer(this),
-      linkBuffer(new flitBuffer()),
+      linkBuffer(new flitBuffer()), m_net_ptr(nullptr),
       m_id(p->link_id),
       m_type(NUM_LINK_TYPES_),
       m_latency(p->link_latency),
       link_consumer(nullptr),
-      link_srcQueue(nullptr), m_link_utilized(0),
+      link_srcQueue(nullptr), m_remote_consumer(false),
+      m_link_utilized(0),
       m_vc_load(p->vcs_per_vnet * p->virt_nets)
 {
 }
@@ -69,14 +73,34 @@ NetworkLink::wakeup()
     if (link_srcQueue->isReady(curCycle())) {
         flit *t_flit = link_srcQueue->getTopFlit();
         t_flit->set_time(curCycle() + m_latency);
-        linkBuffer->insert(t_flit);
-        // because LinkConsumer could be anyone; either NI or Router
-        link_consumer->scheduleEventAbsolute(clockEdge(m_latency));
+        if (m_remote_consumer) {
+            m_mailbox.push_back(t_flit);
+        } else {
+            linkBuffer->insert(t_flit);
+            // because LinkConsumer could be anyone; either NI or Router
+            link_consumer->scheduleEventAbsolute(clockEdge(m_latency));
+        }
         m_link_utilized++;
         m_vc_load[t_flit->get_vc()]++;
     }
 }
 
+// Called from GarnetNetwork::partitionSync(), before any consumer has
+// woken up for this tick. A flit whose arrival time has already passed
+// (quantum longer than the link) is delivered now.
+void
+NetworkLink::deliverMailbox()
+{
+    for (auto t_flit : m_mailbox) {
+        linkBuffer->insert(t_flit);
+        Cycles now = curCycle();
+        Cycles delay = (t_flit->get_time() > now) ?
+            Cycles(t_flit->get_time() - now) : Cycles(0);
+        link_consumer->scheduleEventAbsolute(clockEdge(delay));
+    }
+    m_mailbox.clear();
+}
+
 void
 NetworkLink::resetStats()
 {
@@ -102,5 +126,76 @@ CreditLinkParams::create()
 uint32_t
 NetworkLink::functionalWrite(Packet *pkt)
 {
-    return linkBuffer->functionalWrite(pkt);
+    uint32_t num_functional_writes = linkBuffer->functionalWrite(pkt);
+    for (auto t_flit : m_mailbox) {
+        if (t_flit->functionalWrite(pkt))
+            num_functional_writes++;
+    }
+    return num_functional_writes;
+}
+
+template <class T>
+void
+NetworkLink::serializeFlits(CheckpointOut &cp) const
+{
+    serializeFlitBuffer<T>(cp, "link_buffer", linkBuffer);
+    ::serializeFlits<T>(cp, "mailbox", m_mailbox);
+}
+
+template <class T>
+void
+NetworkLink::unserializeFlits(CheckpointIn &cp, flitPool<T> &pool)
+{
+    unserializeFlitBuffer(cp, "link_buffer", linkBuffer, pool);
+    for (auto t_flit : ::unserializeFlits(cp, "mailbox", pool))
+        m_mailbox.push_back(t_flit);
+
+    // mailbox flits are handed over at the next quantum boundary
+    scheduleRestoredFlits(link_consumer, this, linkBuffer);
+}
+
+template <class T>
+void
+NetworkLink::clearFlits(flitPool<T> &pool)
+{
+    linkBuffer->clear(pool);
+    for (auto t_flit : m_mailbox)
+        pool.release(static_cast<T *>(t_flit));
+    m_mailbox.clear();
+}
+
+void
+NetworkLink::resetState()
+{
+    clearFlits(m_net_ptr->getFlitPool());
+}
+
+void
+CreditLink::resetState()
+{
+    clearFlits(m_net_ptr->getCreditPool());
+}
+
+void
+NetworkLink::serialize(CheckpointOut &cp) const
+{
+    serializeFlits<flit>(cp);
+}
+
+void
+NetworkLink::unserialize(CheckpointIn &cp)
+{
+    unserializeFlits(cp, m_net_ptr->getFlitPool());
+}
+
+void
+CreditLink::serialize(CheckpointOut &cp) const
+{
+    serializeFlits<Credit>(cp);
+}
+
+void
+CreditLink::unserialize(CheckpointIn &cp)
+{
+    unserializeFlits(cp, m_net_ptr->getCreditPool());
 }
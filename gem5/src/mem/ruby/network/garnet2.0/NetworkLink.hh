@@ -40,6 +40,7 @@
 #include "mem/ruby/common/Consumer.hh"
 #include "mem/ruby/network/garnet2.0/CommonTypes.hh"
 #include "mem/ruby/network/garnet2.0/flitBuffer.hh"
+#include "mem/ruby/network/garnet2.0/flitPool.hh"
 #include "params/NetworkLink.hh"
 #include "sim/clocked_object.hh"
 
@@ -58,8 +59,16 @@ class NetworkLink : public ClockedObject, public Consumer
     link_type getType() { return m_type; }
     void print(std::ostream& out) const {}
     int get_id() const { return m_id; }
+    Cycles get_latency() const { return m_latency; }
     void wakeup();
 
+    // The consumer runs on another event queue (network partition):
+    // flits wait in a mailbox until deliverMailbox() is called at the
+    // next quantum boundary, with every partition stopped.
+    void setRemoteConsumer() { m_remote_consumer = true; }
+    bool hasRemoteConsumer() const { return m_remote_consumer; }
+    void deliverMailbox();
+
     unsigned int getLinkUtilization() const { return m_link_utilized; }
     const std::vector<unsigned int> & getVcLoad() const { return m_vc_load; }
     void scan() {   linkBuffer->scan(); }
@@ -71,8 +80,24 @@ class NetworkLink : public ClockedObject, public Consumer
 
     uint32_t functionalWrite(Packet *);
     void resetStats();
+    // drop the flits on the link and in its mailbox
+    virtual void resetState();
+
+    // Checkpointing of the flits on the link and in its mailbox; a
+    // CreditLink carries credits instead.
+    void init_net_ptr(GarnetNetwork *net_ptr) { m_net_ptr = net_ptr; }
+    void serialize(CheckpointOut &cp) const override;
+    void unserialize(CheckpointIn &cp) override;
 
   flitBuffer *linkBuffer;
+  protected:
+    template <class T> void serializeFlits(CheckpointOut &cp) const;
+    template <class T> void unserializeFlits(CheckpointIn &cp,
+                                             flitPool<T> &pool);
+    template <class T> void clearFlits(flitPool<T> &pool);
+
+    GarnetNetwork *m_net_ptr;
+
   private:
     const int m_id;
     link_type m_type;
@@ -81,6 +106,9 @@ class NetworkLink : public ClockedObject, public Consumer
     Consumer *link_consumer;
     flitBuffer *link_srcQueue;
 
+    bool m_remote_consumer;
+    std::vector<flit *> m_mailbox;
+
     // Statistical variables
     unsigned int m_link_utilized;
     std::vector<unsigned int> m_vc_load;
@@ -63,3 +63,38 @@ OutVcState::decrement_credit()
     m_credit_count--;
     assert(m_credit_count >= 0);
 }
+
+void
+serializeOutVcStates(CheckpointOut &cp, const std::string &name,
+                     const std::vector<OutVcState *> &states)
+{
+    std::vector<int> vc_state, credits;
+    std::vector<uint64_t> time;
+    for (auto state : states) {
+        vc_state.push_back(state->get_state());
+        time.push_back(state->get_time());
+        credits.push_back(state->get_credit_count());
+    }
+    arrayParamOut(cp, name + "_state", vc_state);
+    arrayParamOut(cp, name + "_time", time);
+    arrayParamOut(cp, name + "_credits", credits);
+}
+
+void
+unserializeOutVcStates(CheckpointIn &cp, const std::string &name,
+                       const std::vector<OutVcState *> &states)
+{
+    std::vector<int> vc_state, credits;
+    std::vector<uint64_t> time;
+    arrayParamIn(cp, name + "_state", vc_state);
+    arrayParamIn(cp, name + "_time", time);
+    arrayParamIn(cp, name + "_credits", credits);
+    fatal_if(vc_state.size() != states.size(),
+             "Checkpoint has %d VCs for %s, the network has %d\n",
+             vc_state.size(), name, states.size());
+
+    for (int vc = 0; vc < states.size(); vc++) {
+        states[vc]->setState((VC_state_type) vc_state[vc], Cycles(time[vc]));
+        states[vc]->set_credit_count(credits[vc]);
+    }
+}
@@ -36,6 +36,7 @@
 
 #include "mem/ruby/network/garnet2.0/CommonTypes.hh"
 #include "mem/ruby/network/garnet2.0/GarnetNetwork.hh"
+#include "sim/serialize.hh"
 
 class OutVcState
 {
@@ -43,6 +44,8 @@ class OutVcState
     OutVcState(int id, GarnetNetwork *network_ptr);
 
     int get_credit_count()          { return m_credit_count; }
+    int get_max_credit_count()      { return m_max_credit_count; }
+    void set_credit_count(int count) { m_credit_count = count; }
     inline bool has_credit()       { return (m_credit_count > 0); }
     void increment_credit();
     void decrement_credit();
@@ -52,6 +55,9 @@ class OutVcState
     {
         return ((m_vc_state == state) && (request_time >= m_time) );
     }
+    VC_state_type get_state()       { return m_vc_state; }
+    Cycles get_time()               { return m_time; }
+
     inline void
     setState(VC_state_type state, Cycles time)
     {
@@ -59,6 +65,14 @@ class OutVcState
         m_time = time;
     }
 
+    // back to idle with every downstream buffer free
+    void
+    reset(Cycles time)
+    {
+        setState(IDLE_, time);
+        m_credit_count = m_max_credit_count;
+    }
+
   private:
     int m_id ;
     Cycles m_time;
@@ -67,4 +81,11 @@ class OutVcState
     int m_max_credit_count;
 };
 
+// Checkpointing of the output VC states of a router outport or an NI,
+// as the arrays '<name>_state', '<name>_time' and '<name>_credits'
+void serializeOutVcStates(CheckpointOut &cp, const std::string &name,
+                          const std::vector<OutVcState *> &states);
+void unserializeOutVcStates(CheckpointIn &cp, const std::string &name,
+                            const std::vector<OutVcState *> &states);
+
 #endif // __MEM_RUBY_NETWORK_GARNET_OUTVC_STATE_HH__
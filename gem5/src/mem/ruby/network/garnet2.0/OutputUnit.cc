@@ -36,6 +36,7 @@
 #include "base/stl_helpers.hh"
 #include "debug/RubyNetwork.hh"
 #include "mem/ruby/network/garnet2.0/Credit.hh"
+#include "mem/ruby/network/garnet2.0/FlitCheckpoint.hh"
 #include "mem/ruby/network/garnet2.0/Router.hh"
 
 using namespace std;
@@ -54,6 +55,12 @@ OutputUnit::OutputUnit(int id, PortDirection direction, Router *router)
     for (int i = 0; i < m_num_vcs; i++) {
         m_outvc_state.push_back(new OutVcState(i, m_router->get_net_ptr()));
     }
+
+    GarnetNetwork *net_ptr = m_router->get_net_ptr();
+    m_occupancy = 0;
+    m_regional = (net_ptr->getRoutingAlgorithm() == CONGESTION_ &&
+                  net_ptr->isCongestionRegional());
+    m_regional_congestion = 0;
 }
 
 OutputUnit::~OutputUnit()
@@ -70,6 +77,7 @@ OutputUnit::decrement_credit(int out_vc)
             m_router->get_id(), m_id, out_vc, m_router->curCycle());
 
     m_outvc_state[out_vc]->decrement_credit();
+    m_occupancy++;
 }
 
 void
@@ -80,6 +88,21 @@ OutputUnit::increment_credit(int out_vc)
             m_router->get_id(), m_id, out_vc, m_router->curCycle());
 
     m_outvc_state[out_vc]->increment_credit();
+    m_occupancy--;
+}
+
+// Latest estimate received from the downstream router that is at least
+// congestion_delay cycles old
+int
+OutputUnit::get_regional_congestion()
+{
+    Cycles curTime = m_router->curCycle();
+    while (!m_regional_pending.empty() &&
+           m_regional_pending.front().first <= curTime) {
+        m_regional_congestion = m_regional_pending.front().second;
+        m_regional_pending.pop_front();
+    }
+    return m_regional_congestion;
 }
 
 // Check if the output VC (i.e., input VC at next router)
@@ -139,7 +162,16 @@ OutputUnit::wakeup()
         if (t_credit->is_free_signal())
             set_vc_state(IDLE_, t_credit->get_vc(), m_router->curCycle());
 
-        delete t_credit;
+        if (m_regional) {
+            // keeps the queue to the credits of the last delay cycles
+            get_regional_congestion();
+            m_regional_pending.push_back(std::make_pair(
+                m_router->curCycle() +
+                    m_router->get_net_ptr()->getCongestionDelay(),
+                t_credit->get_congestion()));
+        }
+
+        m_router->get_net_ptr()->getCreditPool().release(t_credit);
     }
 }
 
@@ -166,3 +198,61 @@ OutputUnit::functionalWrite(Packet *pkt)
 {
     return m_out_buffer->functionalWrite(pkt);
 }
+
+void
+OutputUnit::resetState()
+{
+    for (auto outvc_state : m_outvc_state)
+        outvc_state->reset(m_router->curCycle());
+    m_out_buffer->clear(m_router->get_net_ptr()->getFlitPool());
+    m_occupancy = 0;
+    m_regional_congestion = 0;
+    m_regional_pending.clear();
+}
+
+void
+OutputUnit::serialize(CheckpointOut &cp) const
+{
+    serializeOutVcStates(cp, "outvc", m_outvc_state);
+    serializeFlitBuffer<flit>(cp, "out_buffer", m_out_buffer);
+
+    // neighbour estimates received on credits, still in flight
+    std::vector<uint64_t> pending_time;
+    std::vector<int> pending_value;
+    for (const auto &pending : m_regional_pending) {
+        pending_time.push_back(pending.first);
+        pending_value.push_back(pending.second);
+    }
+    SERIALIZE_SCALAR(m_regional_congestion);
+    arrayParamOut(cp, "regional_pending_time", pending_time);
+    arrayParamOut(cp, "regional_pending_value", pending_value);
+}
+
+void
+OutputUnit::unserialize(CheckpointIn &cp)
+{
+    unserializeOutVcStates(cp, "outvc", m_outvc_state);
+    m_occupancy = 0;
+    for (auto outvc_state : m_outvc_state) {
+        m_occupancy += outvc_state->get_max_credit_count() -
+                       outvc_state->get_credit_count();
+    }
+    unserializeFlitBuffer(cp, "out_buffer", m_out_buffer,
+                          m_router->get_net_ptr()->getFlitPool());
+    scheduleRestoredFlits(m_out_link, m_router, m_out_buffer);
+
+    std::vector<uint64_t> pending_time;
+    std::vector<int> pending_value;
+    UNSERIALIZE_SCALAR(m_regional_congestion);
+    arrayParamIn(cp, "regional_pending_time", pending_time);
+    arrayParamIn(cp, "regional_pending_value", pending_value);
+    fatal_if(pending_time.size() != pending_value.size(),
+             "Checkpoint of %s has %d pending congestion cycles but %d "
+             "values\n", m_router->name(), pending_time.size(),
+             pending_value.size());
+    m_regional_pending.clear();
+    for (int i = 0; i < pending_time.size(); i++) {
+        m_regional_pending.push_back(
+            std::make_pair(Cycles(pending_time[i]), pending_value[i]));
+    }
+}
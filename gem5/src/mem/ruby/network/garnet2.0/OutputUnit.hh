@@ -34,7 +34,9 @@
 #ifndef __MEM_RUBY_NETWORK_GARNET_OUTPUT_UNIT_HH__
 #define __MEM_RUBY_NETWORK_GARNET_OUTPUT_UNIT_HH__
 
+#include <deque>
 #include <iostream>
+#include <utility>
 #include <vector>
 
 #include "mem/ruby/common/Consumer.hh"
@@ -44,8 +46,9 @@
 #include "mem/ruby/network/garnet2.0/OutVcState.hh"
 #include "mem/ruby/network/garnet2.0/Router.hh"
 #include "mem/ruby/network/garnet2.0/flitBuffer.hh"
+#include "sim/serialize.hh"
 
-class OutputUnit : public Consumer
+class OutputUnit : public Consumer, public Serializable
 {
   public:
     OutputUnit(int id, PortDirection direction, Router *router);
@@ -96,7 +99,34 @@ class OutputUnit : public Consumer
         m_out_link->scheduleEventAbsolute(m_router->clockEdge(Cycles(1)));
     }
 
+    // Congestion signals for CONGESTION_ routing, kept per outport:
+    // the downstream buffer slots in use, counted with the credits,
+    // and the downstream router's estimate for the same direction,
+    // which arrives on its credits and is used congestion_delay
+    // cycles later. get_congestion() is what the route selection
+    // compares; get_congestion_estimate() is sent further upstream.
+    int get_occupancy() { return m_occupancy; }
+    int get_regional_congestion();
+    int
+    get_congestion()
+    {
+        return m_regional ? m_occupancy + get_regional_congestion()
+                          : m_occupancy;
+    }
+    int
+    get_congestion_estimate()
+    {
+        return (m_occupancy + get_regional_congestion()) / 2;
+    }
+
     uint32_t functionalWrite(Packet *pkt);
+    // drop the queued flits, all downstream VCs idle with full credits
+    void resetState();
+
+    // downstream VC states, queued flits and the regional congestion
+    // estimate (see Router::serialize())
+    void serialize(CheckpointOut &cp) const override;
+    void unserialize(CheckpointIn &cp) override;
 
     inline int get_id() { return m_id; }
   NetworkLink *m_out_link;
@@ -112,6 +142,12 @@ class OutputUnit : public Consumer
 
     flitBuffer *m_out_buffer; // This is for the network link to consume
 
+    int m_occupancy;
+    // regional congestion: only tracked under CONGESTION_ routing
+    bool m_regional;
+    int m_regional_congestion;
+    std::deque<std::pair<Cycles, int> > m_regional_pending;
+
 };
 
 #endif // __MEM_RUBY_NETWORK_GARNET_OUTPUT_UNIT_HH__
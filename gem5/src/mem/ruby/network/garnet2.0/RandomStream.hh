@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET_RANDOM_STREAM_HH__
+#define __MEM_RUBY_NETWORK_GARNET_RANDOM_STREAM_HH__
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "base/logging.hh"
+#include "sim/serialize.hh"
+
+// A small xoshiro128** generator. Every router owns one, seeded from
+// the network's random_seed and the router id, so the random choices
+// of a router (routing, table tie-breaks) do not depend on what any
+// other object drew or in which order objects were evaluated.
+class RandomStream
+{
+  public:
+    RandomStream() { seed(1, 0); }
+
+    // (seed, stream) pairs give unrelated sequences; the four state
+    // words are filled by splitmix64 so they are never all zero
+    void
+    seed(uint32_t seed, uint32_t stream)
+    {
+        uint64_t x = ((uint64_t) stream << 32) | seed;
+        for (int i = 0; i < 4; i += 2) {
+            uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            z ^= z >> 31;
+            m_s[i] = (uint32_t) z;
+            m_s[i + 1] = (uint32_t) (z >> 32);
+        }
+    }
+
+    uint32_t
+    next()
+    {
+        const uint32_t result = rotl(m_s[1] * 5, 7) * 9;
+        const uint32_t t = m_s[1] << 9;
+        m_s[2] ^= m_s[0];
+        m_s[3] ^= m_s[1];
+        m_s[1] ^= m_s[2];
+        m_s[0] ^= m_s[3];
+        m_s[2] ^= t;
+        m_s[3] = rotl(m_s[3], 11);
+        return result;
+    }
+
+    // uniform in [0, n), n > 0 (multiply-shift; the bias is below
+    // n / 2^32)
+    uint32_t
+    random(uint32_t n)
+    {
+        return (uint32_t) (((uint64_t) next() * n) >> 32);
+    }
+
+    void
+    serialize(CheckpointOut &cp, const std::string &name) const
+    {
+        std::vector<uint32_t> state(m_s, m_s + 4);
+        arrayParamOut(cp, name, state);
+    }
+
+    void
+    unserialize(CheckpointIn &cp, const std::string &name)
+    {
+        std::vector<uint32_t> state;
+        arrayParamIn(cp, name, state);
+        fatal_if(state.size() != 4, "bad random stream state '%s'\n",
+                 name);
+        std::copy(state.begin(), state.end(), m_s);
+    }
+
+  private:
+    static uint32_t
+    rotl(uint32_t x, int k)
+    {
+        return (x << k) | (x >> (32 - k));
+    }
+
+    uint32_t m_s[4];
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET_RANDOM_STREAM_HH__
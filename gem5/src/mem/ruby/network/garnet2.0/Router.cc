@@ -69,8 +69,13 @@ Router::Router(const Params *p)
     swap_ptr.inport = -1;
     swap_ptr.vcid = -1;
     swap_ptr.vnet_id = -1;
-    swap_ptr.inport_dirn = "Unknown";
+    swap_ptr.inport_dirn = PortDirection_Unknown;
     send_routedSwap = false;
+    m_swap_colour = 0;
+    m_epoch_swaps_initiated = 0;
+    m_epoch_swaps_done = 0;
+    m_epoch_swaps_failed = 0;
+    m_epoch_bail_outs = 0;
     // print_trigger = Cycles(100);
 }
 
@@ -89,13 +94,44 @@ Router::init()
         DPRINTF(RubyNetwork, "Router::init() gets called\n");
     BasicRouter::init();
 
+    m_rng.seed(m_network_ptr->getRandomSeed(), m_id);
     m_sw_alloc->init();
     m_switch->init();
+    m_routing_unit->init();
+}
+
+bool
+Router::hasActiveVCs()
+{
+    for (int inport = 0; inport < m_input_unit.size(); inport++) {
+        if (m_input_unit[inport]->get_active_vcs() != 0)
+            return true;
+    }
+    return false;
+}
+
+void
+Router::sampleTelemetry(TelemetryRouterRecord &rec)
+{
+    rec.cycle = curCycle();
+    rec.router = m_id;
+    rec.occupancy = 0;
+    for (int inport = 0; inport < m_input_unit.size(); inport++)
+        rec.occupancy += m_input_unit[inport]->get_occupancy();
+    rec.swaps_initiated = m_epoch_swaps_initiated;
+    rec.swaps_done = m_epoch_swaps_done;
+    rec.swaps_failed = m_epoch_swaps_failed;
+    rec.bail_outs = m_epoch_bail_outs;
+
+    m_epoch_swaps_initiated = 0;
+    m_epoch_swaps_done = 0;
+    m_epoch_swaps_failed = 0;
+    m_epoch_bail_outs = 0;
 }
 
 int
 Router::get_numFreeVC(PortDirection dirn_) {
-    assert(dirn_ != "Local");
+    assert(dirn_ != PortDirection_Local);
     int inport_id = m_routing_unit->m_inports_dirn2idx[dirn_];
 
     return (m_input_unit[inport_id]->get_numFreeVC(dirn_));
@@ -149,22 +185,25 @@ Router::wakeup()
         #endif
 
         // Make swap_ptr valid here if possible...
-        if ((swap_ptr.valid == false)) {
+        if ((swap_ptr.valid == false) && hasActiveVCs()) {
              int inport_itr;
              int invc = 0;
              bool swap_ptr_valid = false;
              for(inport_itr=0; inport_itr< m_input_unit.size(); ++inport_itr) {
                 // Just check the VC-base of each VNet in that input unit
                 // if there is a flit presrnt then make the swap_ptr valid.
-                if(m_input_unit[inport_itr]->get_direction() == "Local") {
+                if(m_input_unit[inport_itr]->get_direction() ==
+                   PortDirection_Local) {
                     // if(get_net_ptr()->m_whichToSwap == DISABLE_LOCAL_SWAP_) {
                          continue;
                     // }
                 }
                 else {
+                    uint64_t active_vcs =
+                        m_input_unit[inport_itr]->get_active_vcs();
                     for(int vnet=0; vnet < m_virtual_networks; ++vnet) {
                         invc = vnet*m_vc_per_vnet;
-                        if ( m_input_unit[inport_itr]->vc_isEmpty(invc) == false ) {
+                        if (active_vcs & (1ULL << invc)) {
                             flit* t_flit = m_input_unit[inport_itr]->peekTopFlit(invc);
                             m_input_unit[inport_itr]->makeSwapPtrValid(t_flit);
                             swap_ptr_valid = true;
@@ -189,153 +228,12 @@ Router::wakeup()
 
 
         if ((this->is_myTurn()) && (swap_ptr.valid)) {
-            #if (MY_PRINT)
-                cout << "Router id: " << m_id <<" swap_ptr.valid: "\
-                << swap_ptr.valid <<" swap_ptr.inport: " << swap_ptr.inport <<
-                " swap_ptr.vcid: " << swap_ptr.vcid <<
-                " swap_ptr.inport_dirn: " << swap_ptr.inport_dirn << endl;
-            #endif
-            assert(swap_ptr.inport_dirn ==
-                    m_input_unit[swap_ptr.inport]->get_direction());
-
-            assert((swap_ptr.inport != -1) && (swap_ptr.vcid != -1));
-            // if either
-            // the outport in the flit is "Local"
-            // OR,
-            // when there is no flit in the input queue
-            // then do not do the swap; just change
-            // the direction of swap_ptr of router.
-            // and 'return'
-            if (outportNotLocal()) {
-                #if (MY_PRINT)
-                    cout << "initiating the swap" << endl;
-                #endif
-
-                // Swap is initiated: (update the stats)
-                get_net_ptr()->m_total_initiated_swaps++;
-
-                // Do all of it when 'is_swap' bit is enabled
-                if (get_net_ptr()->m_no_is_swap == 0) {
-                    /*Check for deadlck_symtm first.*/
-                    bool deadlck_symtm = false;
-                    // do this on per vnet basis
-
-                    deadlck_symtm = get_net_ptr()->chk_deadlck_symptm(m_id, 0);
-
-                    if (deadlck_symtm) {
-                        /*initiate bailout sequence and then proceed normally*/
-                        #if (MY_PRINT)
-                        cout << "----initiating bail_out sequence----" << endl;
-                        #endif
-                        get_net_ptr()->bail_out(m_id);
-                        get_net_ptr()->m_total_bailout++;
-                    } else {
-                        // proceed normally via doSwap()
-                    }
-                } else {
-                    // this condition is also true when
-                    // 'm_inj_single_vnet == 0'
-                    assert(get_net_ptr()->m_no_is_swap == 1);
-                }
-                // If the result of GarnetNetwork::doSwap()
-                // is not NULL then remove the flit from inport by doing
-                // getTopFlit
-                #if (MY_PRINT)
-                    cout << "Upstream Router-id: " << m_id <<" swap_ptr.inport: "\
-                         << swap_ptr.inport << endl;
-                    cout << "swap_ptr.vcid: " << swap_ptr.vcid <<" swap_ptr.inport_dirn: "\
-                         << swap_ptr.inport_dirn << endl;
-                    cout << "Candidate flit of upstream router: " << endl;
-                    cout << *m_input_unit[swap_ptr.inport]->peekTopFlit(swap_ptr.vcid)
-                         << endl;
-                #endif
-                // taking care of the case when the flit itself is RoutedSwap
-                // and is pointed by the swap_ptr.
-                if (m_input_unit[swap_ptr.inport]->peekTopFlit(swap_ptr.vcid)\
-                    ->get_RoutedSwap()) {
-                    // here the swapped flit is trying to make forward progress
-                    // via swaps. set the flag, which will be used later to
-                    // clear 'is_swap' bit of this router and
-                    // keep 'routedSwap' bit in the flit high.
-                    #if (MY_PRINT)
-                        cout << "'routedSwap' flit is trying to make forward"\
-                                 "progress via Swap!" << endl;
-                    #endif
-                    if (get_net_ptr()->m_no_is_swap == 0) {
-                        assert(this->is_swap);
-                    }
-                    this->send_routedSwap = true; // setting the flag
-
-                }
-                // because we have made sure swap_ptr always points to non-empty
-                // vcid
-                flit* flit_t = get_net_ptr()->doSwap(
-                                            m_input_unit[swap_ptr.inport]->\
-                                            peekTopFlit(swap_ptr.vcid), m_id);
-
-                // by upstream router:
-                // 1. Recompute the route (happens in doSwap_enqueue())
-                // 2. insert this flit in the router
-                if (flit_t != NULL) {
-                    // remove the flit from the input port of that input unit...
-                    m_input_unit[swap_ptr.inport]->getTopFlit(swap_ptr.vcid);
-                    #if (MY_PRINT)
-                        cout << "Mis-routed flit we got from downstream"\
-                             << "router: " << endl;
-                        cout << *flit_t << endl;
-                        cout <<"Router-id: " << m_id <<
-                            " swap_ptr.inport_dirn: " <<
-                            swap_ptr.inport_dirn <<
-                            " swap_ptr.vcid: " << swap_ptr.vcid <<
-                            endl;
-                    #endif
-                    doSwap_enqueue(flit_t, m_input_unit[swap_ptr.inport]->\
-                                    get_direction(), swap_ptr.inport, swap_ptr.vcid);
-                    #if (MY_PRINT)
-                        cout << "<<<<<<Completed the swap successfully>>>>>"\
-                            << endl;
-                    #endif
-                    // update the stats
-                    get_net_ptr()->increment_total_swaps();
-
-                    if (this->send_routedSwap) {
-                        if (get_net_ptr()->m_no_is_swap == 0) {
-                            assert(this->is_swap);
-                        }
-                        this->send_routedSwap = false;
-                        this->is_swap = false;
-                        // the flit has made forward progress using swaps from
-                        // downstream router
-                        get_net_ptr()->m_total_routedSwaps++;
-                    }
-
-                }
-                else {
-                    // Swap is not possible because either:
-                    // 1. swap_ptr is sending it flit for Local outport out
-                    // 2. Downstream router's inport is empty.. the flit will
-                    // then go by usual SwitchArbiteration mechanism.
-                    // 3. Downstream Router's 'is_swap' bit is high
-                    // 4. Downstream Router's mis-route flit has Local outport
-
-                    //Therfore if 'send_routedSwap' is set before clear it here.
-                    if (this->send_routedSwap) {
-                        if (get_net_ptr()->m_no_is_swap == 0) {
-                            assert(this->is_swap);
-                        }
-                        this->send_routedSwap = false;
-                    }
-                    get_net_ptr()->m_total_failed_swaps++;
-                }
-            }
-            else {
-                // swap is not possible because there is no flit in the
-                // input port's vc-0 in the upstream router to swap with
-            }
-
-            // THis is the upstream router irrespective of completing/not-complting
-            // the swap---update the direction of swap_ptr.
-            movSwapPtr(); // only move swap_ptr when it's valid
+            // a swap reaches into the neighbouring routers, which may be
+            // running on other threads; do it at the quantum boundary
+            if (get_net_ptr()->isPartitioned())
+                get_net_ptr()->deferSwap(m_id);
+            else
+                initiateSwap();
         }
     }
 
@@ -356,7 +254,9 @@ Router::wakeup()
     }
 
     // Switch Allocation
-    m_sw_alloc->wakeup();
+    // (nothing to allocate, nor to wake up for, while all VCs are empty)
+    if (hasActiveVCs())
+        m_sw_alloc->wakeup();
 
     // Switch Traversal
     m_switch->wakeup();
@@ -368,6 +268,167 @@ Router::wakeup()
 }
 
 
+// Initiate a swap from the packet at swap_ptr, which must be valid.
+// Called from wakeup() in this router's TDM slot or, when the network
+// is partitioned, from GarnetNetwork::partitionSync().
+void
+Router::initiateSwap()
+{
+    #if (MY_PRINT)
+        cout << "Router id: " << m_id <<" swap_ptr.valid: "\
+        << swap_ptr.valid <<" swap_ptr.inport: " << swap_ptr.inport <<
+        " swap_ptr.vcid: " << swap_ptr.vcid <<
+        " swap_ptr.inport_dirn: " << swap_ptr.inport_dirn << endl;
+    #endif
+    assert(swap_ptr.inport_dirn ==
+            m_input_unit[swap_ptr.inport]->get_direction());
+
+    assert((swap_ptr.inport != -1) && (swap_ptr.vcid != -1));
+    // if either
+    // the outport in the flit is "Local"
+    // OR,
+    // when there is no flit in the input queue
+    // then do not do the swap; just change
+    // the direction of swap_ptr of router.
+    // and 'return'
+    if (outportNotLocal()) {
+        #if (MY_PRINT)
+            cout << "initiating the swap" << endl;
+        #endif
+
+        // Swap is initiated: (update the stats)
+        get_net_ptr()->m_total_initiated_swaps++;
+        m_epoch_swaps_initiated++;
+
+        // Do all of it when 'is_swap' bit is enabled
+        if (get_net_ptr()->m_no_is_swap == 0) {
+            /*Check for deadlck_symtm first.*/
+            bool deadlck_symtm = false;
+            // do this on per vnet basis
+
+            deadlck_symtm = get_net_ptr()->chk_deadlck_symptm(m_id, 0);
+
+            if (deadlck_symtm) {
+                /*initiate bailout sequence and then proceed normally*/
+                #if (MY_PRINT)
+                cout << "----initiating bail_out sequence----" << endl;
+                #endif
+                get_net_ptr()->bail_out(m_id);
+                get_net_ptr()->m_total_bailout++;
+                m_epoch_bail_outs++;
+            } else {
+                // proceed normally via doSwap()
+            }
+        } else {
+            // this condition is also true when
+            // 'm_inj_single_vnet == 0'
+            assert(get_net_ptr()->m_no_is_swap == 1);
+        }
+        // If the result of GarnetNetwork::doSwap()
+        // is not NULL then remove the flit from inport by doing
+        // getTopFlit
+        #if (MY_PRINT)
+            cout << "Upstream Router-id: " << m_id <<" swap_ptr.inport: "\
+                 << swap_ptr.inport << endl;
+            cout << "swap_ptr.vcid: " << swap_ptr.vcid <<" swap_ptr.inport_dirn: "\
+                 << swap_ptr.inport_dirn << endl;
+            cout << "Candidate flit of upstream router: " << endl;
+            cout << *m_input_unit[swap_ptr.inport]->peekTopFlit(swap_ptr.vcid)
+                 << endl;
+        #endif
+        // taking care of the case when the flit itself is RoutedSwap
+        // and is pointed by the swap_ptr.
+        if (m_input_unit[swap_ptr.inport]->peekTopFlit(swap_ptr.vcid)\
+            ->get_RoutedSwap()) {
+            // here the swapped flit is trying to make forward progress
+            // via swaps. set the flag, which will be used later to
+            // clear 'is_swap' bit of this router and
+            // keep 'routedSwap' bit in the flit high.
+            #if (MY_PRINT)
+                cout << "'routedSwap' flit is trying to make forward"\
+                         "progress via Swap!" << endl;
+            #endif
+            if (get_net_ptr()->m_no_is_swap == 0) {
+                assert(this->is_swap);
+            }
+            this->send_routedSwap = true; // setting the flag
+
+        }
+        // because we have made sure swap_ptr always points to a
+        // vcid holding a whole packet (outportNotLocal())
+        std::vector<flit *> up_pkt, dn_pkt;
+        m_input_unit[swap_ptr.inport]->peekPacket(swap_ptr.vcid,
+                                                  up_pkt);
+        bool swapped = get_net_ptr()->doSwap(up_pkt, m_id, dn_pkt);
+
+        // by upstream router:
+        // 1. Recompute the route (happens in doSwap_enqueue())
+        // 2. insert this packet in the router
+        if (swapped) {
+            // remove the packet from the input port of that input unit...
+            m_input_unit[swap_ptr.inport]->popPacket(swap_ptr.vcid,
+                                                     up_pkt);
+            #if (MY_PRINT)
+                cout << "Mis-routed flit we got from downstream"\
+                     << "router: " << endl;
+                cout << *dn_pkt[0] << endl;
+                cout <<"Router-id: " << m_id <<
+                    " swap_ptr.inport_dirn: " <<
+                    swap_ptr.inport_dirn <<
+                    " swap_ptr.vcid: " << swap_ptr.vcid <<
+                    endl;
+            #endif
+            doSwap_enqueue(dn_pkt, swap_ptr.inport, swap_ptr.vcid,
+                           false);
+            #if (MY_PRINT)
+                cout << "<<<<<<Completed the swap successfully>>>>>"\
+                    << endl;
+            #endif
+            // update the stats
+            get_net_ptr()->increment_total_swaps();
+            m_epoch_swaps_done++;
+
+            if (this->send_routedSwap) {
+                if (get_net_ptr()->m_no_is_swap == 0) {
+                    assert(this->is_swap);
+                }
+                this->send_routedSwap = false;
+                this->is_swap = false;
+                // the flit has made forward progress using swaps from
+                // downstream router
+                get_net_ptr()->m_total_routedSwaps++;
+            }
+
+        }
+        else {
+            // Swap is not possible because either:
+            // 1. swap_ptr is sending it flit for Local outport out
+            // 2. Downstream router's inport is empty.. the flit will
+            // then go by usual SwitchArbiteration mechanism.
+            // 3. Downstream Router's 'is_swap' bit is high
+            // 4. Downstream Router's mis-route flit has Local outport
+
+            //Therfore if 'send_routedSwap' is set before clear it here.
+            if (this->send_routedSwap) {
+                if (get_net_ptr()->m_no_is_swap == 0) {
+                    assert(this->is_swap);
+                }
+                this->send_routedSwap = false;
+            }
+            get_net_ptr()->m_total_failed_swaps++;
+            m_epoch_swaps_failed++;
+        }
+    }
+    else {
+        // swap is not possible because there is no flit in the
+        // input port's vc-0 in the upstream router to swap with
+    }
+
+    // THis is the upstream router irrespective of completing/not-complting
+    // the swap---update the direction of swap_ptr.
+    movSwapPtr(); // only move swap_ptr when it's valid
+}
+
 void
 Router::movSwapPtr() {
     // THis is the upstream router irrespective of completing/not-complting
@@ -391,7 +452,8 @@ Router::movSwapPtr() {
         if (swap_ptr.inport == get_num_inports())
           swap_ptr.inport = 0; // looping over
         if (get_net_ptr()->get_whichToSwap() == DISABLE_LOCAL_SWAP_) {
-            if (m_input_unit[swap_ptr.inport]->get_direction() == "Local")
+            if (m_input_unit[swap_ptr.inport]->get_direction() ==
+                PortDirection_Local)
                 continue;
         }
 
@@ -430,10 +492,10 @@ Router::movSwapPtr() {
         // At this point swap_ptr.inport should be pointing to the next input-unit
         // of upstream router. Therefore, set that direction in the swap_ptr.
         swap_ptr.inport_dirn = m_routing_unit->m_inports_idx2dirn[swap_ptr.inport];
-        assert(swap_ptr.inport_dirn.length() != 0); // shouldn't be an empty string
 
         if (get_net_ptr()->get_whichToSwap() == DISABLE_LOCAL_SWAP_)
-            assert(swap_ptr.inport_dirn != "Local"); // should not point to a local inport
+            // should not point to a local inport
+            assert(swap_ptr.inport_dirn != PortDirection_Local);
 
         #if (MY_PRINT)
             cout << "After movSwapPtr(): swap_ptr.inport: " << swap_ptr.inport << \
@@ -480,6 +542,43 @@ Router::scanRouter() {
 
 }
 
+// Local replacement of the global TDM turn. A router initiates a swap
+// as soon as the flit pointed by swap_ptr has been blocked for
+// swap_stall_threshold cycles, or (when occupancy_swap is set) the
+// inport pointed by swap_ptr is at least that occupied. Idle routers
+// never trigger, and recovery latency does not depend on network size.
+// Conflicts are resolved by colour: neighbouring routers never share a
+// colour (a checkerboard on a mesh) and only one colour initiates in a
+// given cycle, so the downstream router of a swap is never an upstream
+// router of another swap during the same cycle.
+bool
+Router::swapTriggered()
+{
+    Cycles cycle = curCycle() - get_net_ptr()->getSwapEpoch();
+    if ((cycle % get_net_ptr()->getNumSwapColours()) != m_swap_colour)
+        return false;
+
+    if (swap_ptr.valid == false)
+        return false;
+
+    InputUnit *unit = m_input_unit[swap_ptr.inport];
+    if (unit->vc_isEmpty(swap_ptr.vcid))
+        return false;
+
+    if (unit->get_stall_cycles(swap_ptr.vcid, curCycle()) >=
+        get_net_ptr()->m_swap_stall_threshold)
+        return true;
+
+    if (get_net_ptr()->m_occupancy_swap > 0) {
+        int free_vc = unit->get_numFreeVC(unit->get_direction());
+        double occupancy_ = (1.0 - (free_vc/(double)m_vc_per_vnet))*100;
+        if (occupancy_ >= (float)(get_net_ptr()->m_occupancy_swap))
+            return true;
+    }
+
+    return false;
+}
+
 bool
 Router::outportNotLocal() {
     // this will check the flit sitting at
@@ -514,14 +613,19 @@ Router::outportNotLocal() {
         get_net_ptr()->m_total_failed_upstream_empty++;
         return false;
     }
+    if (m_input_unit[inport]->get_packet_size(vcid) == 0) {
+        // only whole packets are swapped: the head flit has left
+        // already or the rest of the packet is still on its way
+        get_net_ptr()->m_total_failed_partial_packet++;
+        return false;
+    }
     int outport = m_input_unit[inport]->peekTopFlit(vcid)->get_outport();
     PortDirection outport_dir = m_input_unit[inport]->\
                                 peekTopFlit(vcid)->get_outport_dir();
     // sanity check:
-    assert(outport_dir.length() != 0);
     assert(m_output_unit[outport]->get_direction() == outport_dir);
 
-    if (outport_dir == "Local") {
+    if (outport_dir == PortDirection_Local) {
         #if (MY_PRINT)
             cout << "Cannot swap because outport of the flit is pointing to"\
                     " local port of this router" << endl;
@@ -533,103 +637,77 @@ Router::outportNotLocal() {
 
 }
 
-flit*
-Router::doSwap(PortDirection inport_dirn, int vcid)
+bool
+Router::doSwap(int inport, int vcid, int pkt_size, std::vector<flit *>& pkt)
 {
     // this should have been taken care of by caller.
-    assert(inport_dirn != "Local");
+    assert(getInportDirection(inport) != PortDirection_Local);
     // additional check.. only swap when all the
     // vcs for the given inport are NOT empty..
-    int inport;
-    inport = m_routing_unit->m_inports_dirn2idx[inport_dirn];
 
     if (get_net_ptr()->m_no_is_swap == 0) {
-        if (is_swap == false) {
-            // using the 'vcid' if this router
-             if (m_input_unit[inport]->vc_isEmpty(vcid)) {
-                get_net_ptr()->m_total_failed_downstream_empty++;
-                return NULL;
-             } else {
-                flit* flit_t = m_input_unit[inport]->peekTopFlit(vcid);
-                // do not return the flit whoes outport is "Local"
-                if (flit_t->get_outport_dir() == "Local") {
-                    get_net_ptr()->m_total_failed_downstream_localOutport;
-                    return NULL;
-                } else {
-                    // now you can remove the flit...
-                    m_input_unit[inport]->getTopFlit(vcid); // remove the flit
-                    return (flit_t);
-                }
-            }
-        }
-        else {
-            return NULL;
-        }
+        if (is_swap == true)
+            return false;
+    } else {
+        assert(get_net_ptr()->m_no_is_swap == 1);
     }
-    else if ( get_net_ptr()->m_no_is_swap == 1 ) {
-         if (m_input_unit[inport]->vc_isEmpty(vcid)) {
-            get_net_ptr()->m_total_failed_downstream_empty++;
-            #if (MY_PRINT)
-                cout << "Declining SWAP because the vcid is empty" << endl;
-            #endif
-            return NULL;
-         } else {
-            flit* flit_t = m_input_unit[inport]->peekTopFlit(vcid);
-            // do not return the flit whoes outport is "Local"
-            if (flit_t->get_outport_dir() == "Local") {
-                get_net_ptr()->m_total_failed_downstream_localOutport;
-                #if (MY_PRINT)
-                    cout << "Declining SWAP because the flit is at its destination" << endl;
-                #endif
-                return NULL;
-            } else {
-                // now you can remove the flit...
-                m_input_unit[inport]->getTopFlit(vcid); // remove the flit
-                return (flit_t);
-            }
-        }
+
+    // using the 'vcid' if this router
+    if (m_input_unit[inport]->vc_isEmpty(vcid)) {
+        get_net_ptr()->m_total_failed_downstream_empty++;
+        #if (MY_PRINT)
+            cout << "Declining SWAP because the vcid is empty" << endl;
+        #endif
+        return false;
     }
-    else {
-        assert(0);
-        return NULL;
+
+    flit* flit_t = m_input_unit[inport]->peekTopFlit(vcid);
+    // do not return the flit whoes outport is "Local"
+    if (flit_t->get_outport_dir() == PortDirection_Local) {
+        get_net_ptr()->m_total_failed_downstream_localOutport++;
+        #if (MY_PRINT)
+            cout << "Declining SWAP because the flit is at its destination" << endl;
+        #endif
+        return false;
     }
+
+    // Packets are exchanged whole, and only for one of the same length:
+    // both vcs then keep their occupancy, so the credits the upstream
+    // routers hold for them stay right.
+    if (m_input_unit[inport]->get_packet_size(vcid) != pkt_size) {
+        get_net_ptr()->m_total_failed_partial_packet++;
+        #if (MY_PRINT)
+            cout << "Declining SWAP because the packets don't match" << endl;
+        #endif
+        return false;
+    }
+
+    // now you can remove the packet...
+    m_input_unit[inport]->popPacket(vcid, pkt);
+    return true;
 }
 
 void
-Router::doSwap_enqueue(flit * flit_t, PortDirection inport_dirn,
-int inport_id, int vcid)
+Router::doSwap_enqueue(const std::vector<flit *>& pkt, int inport_id, int vcid,
+                       bool routed)
 {
+    assert(inport_id != -1);
+    flit *flit_t = pkt[0]; // head flit
+    PortDirection inport_dirn = getInportDirection(inport_id);
     if (get_net_ptr()->get_whichToSwap() == ENABLE_LOCAL_SWAP_) {
-        if (inport_id == -1) // called by upstream router
-            assert(inport_dirn != "Local");
+        if (routed) // called by upstream router
+            assert(inport_dirn != PortDirection_Local);
     } else
-        assert(inport_dirn != "Local");
+        assert(inport_dirn != PortDirection_Local);
     int outport =
-        route_compute(flit_t->get_route(),
-                      m_routing_unit->\
-                      m_inports_dirn2idx[inport_dirn],
-                      inport_dirn);
-    flit_t->set_outport(outport);
-    flit_t->set_outport_dir(m_routing_unit->\
-                            m_outports_idx2dirn[outport]);
-    // set this new vc in the flit (which is same as vcid of the upstream router)
-    flit_t->set_vc(vcid);
-    int vc = flit_t->get_vc();
-    assert(vc != -1);
-    if (inport_id == -1) {
-        // This means we are enqueuing a "Routed" flit
-        // in downstream router.
-        inport_id = m_routing_unit->m_inports_dirn2idx[inport_dirn];
-        assert(inport_id != -1);
-    } else {
-
-        if (get_net_ptr()->m_no_is_swap == 0) {
-            assert(flit_t->get_RoutedSwap() == false);
-        }
-        assert(m_routing_unit->m_inports_idx2dirn[inport_id] ==
-            inport_dirn);
+        route_compute(flit_t->get_route(), inport_id, inport_dirn);
+    // a "Routed" flit is only ever enqueued in the downstream router
+    if (!routed && (get_net_ptr()->m_no_is_swap == 0)) {
+        assert(flit_t->get_RoutedSwap() == false);
     }
-    m_input_unit[inport_id]->enqueue_flit(vc, flit_t);
+    // the whole packet goes in the same vc (which is same as vcid of the
+    // upstream router) and follows the new route
+    m_input_unit[inport_id]->pushPacket(vcid, pkt, outport);
     return;
 
 }
@@ -645,7 +723,7 @@ Router::checkSwapPtrValid() {
 }
 
 void
-Router::makeSwapPtrValid(PortDirection dirn, int vc) {
+Router::makeSwapPtrValid(int inport, PortDirection dirn, int vc) {
     #if (MY_PRINT)
         cout << "Router::makeSwapPtrValid(); Direction: " << dirn << endl;
     #endif
@@ -654,8 +732,9 @@ Router::makeSwapPtrValid(PortDirection dirn, int vc) {
     swap_ptr.valid = true;
     swap_ptr.inport_dirn = dirn;
     swap_ptr.vcid = vc;
-    assert(dirn != "Local");
-    swap_ptr.inport = m_routing_unit->m_inports_dirn2idx[dirn];
+    assert(dirn != PortDirection_Local);
+    // by index: several inports may share PortDirection_Unknown
+    swap_ptr.inport = inport;
     return;
 }
 
@@ -673,6 +752,7 @@ Router::addInPort(PortDirection inport_dirn,
     credit_link->setSourceQueue(input_unit->getCreditQueue());
 
     m_input_unit.push_back(input_unit);
+    m_upstream_id.push_back(-1);
 
     m_routing_unit->addInDirection(inport_dirn, port_num);
 }
@@ -692,12 +772,27 @@ Router::addOutPort(PortDirection outport_dirn,
     out_link->setSourceQueue(output_unit->getOutQueue());
 
     m_output_unit.push_back(output_unit);
+    m_downstream_id.push_back(-1);
+    m_downstream_inport.push_back(-1);
 
     m_routing_unit->addRoute(routing_table_entry);
     m_routing_unit->addWeight(link_weight);
     m_routing_unit->addOutDirection(outport_dirn, port_num);
 }
 
+void
+Router::setOutportNeighbour(int outport, int router_id, int inport)
+{
+    m_downstream_id[outport] = router_id;
+    m_downstream_inport[outport] = inport;
+}
+
+void
+Router::setInportNeighbour(int inport, int router_id)
+{
+    m_upstream_id[inport] = router_id;
+}
+
 PortDirection
 Router::getOutportDirection(int outport)
 {
@@ -711,7 +806,8 @@ Router::getInportDirection(int inport)
 }
 
 int
-Router::route_compute(RouteInfo route, int inport, PortDirection inport_dirn)
+Router::route_compute(const RouteInfo &route, int inport,
+                      PortDirection inport_dirn)
 {
     return m_routing_unit->outportCompute(route, inport, inport_dirn);
 }
@@ -720,6 +816,7 @@ void
 Router::grant_switch(int inport, flit *t_flit)
 {
     m_switch->update_sw_winner(inport, t_flit);
+    m_network_ptr->traceFlit(FLIT_SA_, t_flit, m_id, inport);
 }
 
 void
@@ -732,11 +829,7 @@ Router::schedule_wakeup(Cycles time)
 std::string
 Router::getPortDirectionName(PortDirection direction)
 {
-    // PortDirection is actually a string
-    // If not, then this function should add a switch
-    // statement to convert direction to a string
-    // that can be printed out
-    return direction;
+    return PortDirection_to_string(direction);
 }
 
 void
@@ -844,6 +937,88 @@ Router::functionalWrite(Packet *pkt)
     return num_functional_writes;
 }
 
+void
+Router::resetState()
+{
+    for (auto input_unit : m_input_unit)
+        input_unit->resetState();
+    for (auto output_unit : m_output_unit)
+        output_unit->resetState();
+    m_sw_alloc->resetState();
+    m_switch->resetState();
+
+    curr_inport = -1;
+    is_swap = false;
+    swap_ptr.valid = false;
+    swap_ptr.inport = -1;
+    swap_ptr.vcid = -1;
+    swap_ptr.vnet_id = -1;
+    swap_ptr.inport_dirn = PortDirection_Unknown;
+    send_routedSwap = false;
+    m_epoch_swaps_initiated = 0;
+    m_epoch_swaps_done = 0;
+    m_epoch_swaps_failed = 0;
+    m_epoch_bail_outs = 0;
+    // every parameter point replays the same random choices
+    m_rng.seed(m_network_ptr->getRandomSeed(), m_id);
+}
+
+void
+Router::serialize(CheckpointOut &cp) const
+{
+    SERIALIZE_SCALAR(is_swap);
+    SERIALIZE_SCALAR(send_routedSwap);
+    SERIALIZE_SCALAR(curr_inport);
+    paramOut(cp, "swap_ptr.valid", swap_ptr.valid);
+    paramOut(cp, "swap_ptr.inport", swap_ptr.inport);
+    paramOut(cp, "swap_ptr.vcid", swap_ptr.vcid);
+    paramOut(cp, "swap_ptr.vnet_id", swap_ptr.vnet_id);
+    paramOut(cp, "swap_ptr.inport_dirn", (int) swap_ptr.inport_dirn);
+    m_rng.serialize(cp, "rng");
+
+    for (int inport = 0; inport < m_input_unit.size(); inport++) {
+        m_input_unit[inport]->serializeSection(cp,
+            csprintf("inport%d", inport));
+    }
+    for (int outport = 0; outport < m_output_unit.size(); outport++) {
+        m_output_unit[outport]->serializeSection(cp,
+            csprintf("outport%d", outport));
+    }
+    m_sw_alloc->serializeSection(cp, "sw_alloc");
+    m_switch->serializeSection(cp, "switch");
+}
+
+void
+Router::unserialize(CheckpointIn &cp)
+{
+    UNSERIALIZE_SCALAR(is_swap);
+    UNSERIALIZE_SCALAR(send_routedSwap);
+    UNSERIALIZE_SCALAR(curr_inport);
+    paramIn(cp, "swap_ptr.valid", swap_ptr.valid);
+    paramIn(cp, "swap_ptr.inport", swap_ptr.inport);
+    paramIn(cp, "swap_ptr.vcid", swap_ptr.vcid);
+    paramIn(cp, "swap_ptr.vnet_id", swap_ptr.vnet_id);
+    int inport_dirn;
+    paramIn(cp, "swap_ptr.inport_dirn", inport_dirn);
+    swap_ptr.inport_dirn = (PortDirection) inport_dirn;
+    m_rng.unserialize(cp, "rng");
+
+    for (int inport = 0; inport < m_input_unit.size(); inport++) {
+        m_input_unit[inport]->unserializeSection(cp,
+            csprintf("inport%d", inport));
+    }
+    for (int outport = 0; outport < m_output_unit.size(); outport++) {
+        m_output_unit[outport]->unserializeSection(cp,
+            csprintf("outport%d", outport));
+    }
+    m_sw_alloc->unserializeSection(cp, "sw_alloc");
+    m_switch->unserializeSection(cp, "switch");
+
+    // pick up where the checkpointed router left off; its wakeup of
+    // the checkpoint cycle has already run
+    scheduleEventAbsolute(clockEdge(Cycles(1)));
+}
+
 Router *
 GarnetRouterParams::create()
 {
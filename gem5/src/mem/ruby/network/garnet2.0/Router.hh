@@ -42,6 +42,8 @@
 #include "mem/ruby/network/BasicRouter.hh"
 #include "mem/ruby/network/garnet2.0/CommonTypes.hh"
 #include "mem/ruby/network/garnet2.0/GarnetNetwork.hh"
+#include "mem/ruby/network/garnet2.0/RandomStream.hh"
+#include "mem/ruby/network/garnet2.0/Telemetry.hh"
 #include "mem/ruby/network/garnet2.0/flit.hh"
 #include "params/GarnetRouter.hh"
 
@@ -79,10 +81,29 @@ class Router : public BasicRouter, public Consumer
     int get_num_inports()   { return m_input_unit.size(); }
     int get_num_outports()  { return m_output_unit.size(); }
     int get_id()            { return m_id; }
+    // this router's own random stream (see RandomStream.hh)
+    RandomStream &get_rng() { return m_rng; }
 
 
     int get_numFreeVC(PortDirection dirn_);
 
+    // Neighbour tables, filled from the internal links when the
+    // topology is built; -1 for ports that connect to an NI.
+    void setOutportNeighbour(int outport, int router_id, int inport);
+    void setInportNeighbour(int inport, int router_id);
+    int get_downstreamId(int outport)     { return m_downstream_id[outport]; }
+    int get_downstreamInport(int outport) { return m_downstream_inport[outport]; }
+    int get_upstreamId(int inport)        { return m_upstream_id[inport]; }
+
+    // colour of this router in the swap colouring of the router graph
+    int get_swap_colour()           { return m_swap_colour; }
+    void set_swap_colour(int colour) { m_swap_colour = colour; }
+    // true if any input VC of this router holds a flit
+    bool hasActiveVCs();
+    // fill in this router's record for the telemetry epoch that ends
+    // now and start counting the next one
+    void sampleTelemetry(TelemetryRouterRecord &rec);
+
     void vcStateDump(void);
 
     void init_net_ptr(GarnetNetwork* net_ptr)
@@ -97,7 +118,8 @@ class Router : public BasicRouter, public Consumer
     PortDirection getOutportDirection(int outport);
     PortDirection getInportDirection(int inport);
 
-    int route_compute(RouteInfo route, int inport, PortDirection direction);
+    int route_compute(const RouteInfo &route, int inport,
+                      PortDirection direction);
     void grant_switch(int inport, flit *t_flit);
     void schedule_wakeup(Cycles time);
 
@@ -122,8 +144,19 @@ class Router : public BasicRouter, public Consumer
 
     uint32_t functionalWrite(Packet *);
 
+    // Back to the state after init(): no buffered flits or credits,
+    // every VC idle, swap state cleared (see
+    // GarnetNetwork::resetNetwork())
+    void resetState();
+
+    // Checkpointing of the buffered flits, VC and credit state and
+    // the swap state; the input and output units, the switch
+    // allocator and the crossbar get a section each.
+    void serialize(CheckpointOut &cp) const override;
+    void unserialize(CheckpointIn &cp) override;
+
     bool checkSwapPtrValid();
-    void makeSwapPtrValid(PortDirection dirn, int vcid);
+    void makeSwapPtrValid(int inport, PortDirection dirn, int vcid);
     // InterSwap
     // 'is_swap' to avoid downstram router taking part in
     // swap on the request of upstream router
@@ -142,14 +175,22 @@ class Router : public BasicRouter, public Consumer
 	} swap_ptr;
 
     void movSwapPtr();
+    // start a swap from the packet at swap_ptr (see wakeup())
+    void initiateSwap();
+    // ADAPTIVE_ 'whenToSwap': true when this router should initiate
+    // a swap in the current cycle
+    bool swapTriggered();
     bool outportNotLocal();
 	// Router's doSwap function: it will check if the queue
-	// is empty or not; of empty then return NULL otherwise
-	// return the head-flit from that input-queue
-	flit* doSwap(PortDirection inport_dirn, int vcid);
+	// is empty or not; of empty then return false otherwise
+	// remove the packet at the head of that input-queue into 'pkt',
+	// provided it is whole and 'pkt_size' flits long
+	bool doSwap(int inport, int vcid, int pkt_size, std::vector<flit *>& pkt);
 
-    // this will enqueue the flit into the input queue
-    void doSwap_enqueue(flit* flit_t, PortDirection inport_dirn, int inport_id, int vcid);
+    // this will enqueue the packet into the input queue; 'routed' is set
+    // when the downstream router receives the packet of the upstream one
+    void doSwap_enqueue(const std::vector<flit *>& pkt, int inport_id,
+                        int vcid, bool routed);
 
     void scanRouter( void );
 
@@ -173,7 +214,11 @@ class Router : public BasicRouter, public Consumer
 
         int tdm_ = get_net_ptr()->get_whenToSwap();
 
-        if (curCycle()%(tdm_*(get_net_ptr()->getNumRouters())) == m_id) {
+        if (tdm_ == ADAPTIVE_)
+            return swapTriggered();
+
+        Cycles cycle = curCycle() - get_net_ptr()->getSwapEpoch();
+        if (cycle % (tdm_*(get_net_ptr()->getNumRouters())) == m_id) {
             return true;
         } else {
             return false;
@@ -262,13 +307,25 @@ class Router : public BasicRouter, public Consumer
 
   private:
     bool send_routedSwap;
+    int m_swap_colour;
+    // swap events in the current telemetry epoch
+    uint32_t m_epoch_swaps_initiated;
+    uint32_t m_epoch_swaps_done;
+    uint32_t m_epoch_swaps_failed;
+    uint32_t m_epoch_bail_outs;
     Cycles m_latency;
     // Cycles print_trigger;
     int m_virtual_networks, m_num_vcs, m_vc_per_vnet;
     GarnetNetwork *m_network_ptr;
+    RandomStream m_rng;
 
     std::vector<InputUnit *> m_input_unit;
     std::vector<OutputUnit *> m_output_unit;
+    // per outport: neighbour router and its inport
+    std::vector<int> m_downstream_id;
+    std::vector<int> m_downstream_inport;
+    // per inport: neighbour router
+    std::vector<int> m_upstream_id;
     SwitchAllocator *m_sw_alloc;
     CrossbarSwitch *m_switch;
 
@@ -33,8 +33,11 @@
 
 #include "mem/ruby/network/garnet2.0/RoutingUnit.hh"
 
+#include <algorithm>
+
 #include "base/cast.hh"
 #include "mem/ruby/network/garnet2.0/InputUnit.hh"
+#include "mem/ruby/network/garnet2.0/OutputUnit.hh"
 #include "mem/ruby/network/garnet2.0/Router.hh"
 #include "mem/ruby/slicc_interface/Message.hh"
 
@@ -43,6 +46,94 @@ RoutingUnit::RoutingUnit(Router *router)
     m_router = router;
     m_routing_table.clear();
     m_weight_table.clear();
+    m_num_nis = 0;
+    m_inports_dirn2idx.assign(PortDirection_NUM, -1);
+    m_outports_dirn2idx.assign(PortDirection_NUM, -1);
+    m_route_function = &RoutingUnit::outportComputeFor<TABLE_>;
+    m_my_id = -1;
+    m_num_cols = -1;
+    m_my_x = -1;
+    m_my_y = -1;
+}
+
+// the direction straight across a mesh router from 'dirn'
+static PortDirection
+oppositeDirection(PortDirection dirn)
+{
+    switch (dirn) {
+      case PortDirection_North: return PortDirection_South;
+      case PortDirection_South: return PortDirection_North;
+      case PortDirection_East: return PortDirection_West;
+      case PortDirection_West: return PortDirection_East;
+      default: return PortDirection_Unknown;
+    }
+}
+
+void
+RoutingUnit::init()
+{
+    GarnetNetwork *net_ptr = m_router->get_net_ptr();
+    m_my_id = m_router->get_id();
+    m_num_cols = net_ptr->getNumCols();
+    if (m_num_cols > 0) {
+        m_my_x = m_my_id % m_num_cols;
+        m_my_y = m_my_id / m_num_cols;
+    }
+
+    m_downstream_unit.assign(PortDirection_NUM, NULL);
+    for (int dirn = 0; dirn < PortDirection_NUM; dirn++) {
+        int outport = m_outports_dirn2idx[dirn];
+        if (outport == -1 || m_router->get_downstreamId(outport) == -1)
+            continue;
+        Router *downstream =
+            net_ptr->get_downstreamRouter((PortDirection) dirn, m_my_id);
+        m_downstream_unit[dirn] = downstream->get_inputUnit_ref()[
+            m_router->get_downstreamInport(outport)];
+    }
+
+    // Routing Algorithm set in GarnetNetwork.py
+    // Can be over-ridden from command line using --routing-algorithm = 1
+    RoutingAlgorithm routing_algorithm =
+        (RoutingAlgorithm) net_ptr->getRoutingAlgorithm();
+
+    // CONGESTION_ routing: the credits sent back through an inport carry
+    // the estimate of the outport straight across (see OutputUnit.hh)
+    if (routing_algorithm == CONGESTION_ && net_ptr->isCongestionRegional()) {
+        for (int inport = 0; inport < m_inports_idx2dirn.size(); inport++) {
+            PortDirection straight =
+                oppositeDirection(m_inports_idx2dirn[inport]);
+            if (straight != PortDirection_Unknown &&
+                m_outports_dirn2idx[straight] != -1) {
+                m_router->get_inputUnit_ref()[inport]->set_congestion_outport(
+                    m_outports_dirn2idx[straight]);
+            }
+        }
+    }
+    bool mesh_routing = ((routing_algorithm >= XY_ &&
+                          routing_algorithm <= ADAPT_WestFirst_) ||
+                         routing_algorithm == CONGESTION_);
+    fatal_if(mesh_routing && m_num_cols <= 0,
+             "Routing algorithm %d needs a mesh topology\n",
+             routing_algorithm);
+
+    switch (routing_algorithm) {
+        case XY_: m_route_function =
+            &RoutingUnit::outportComputeFor<XY_>; break;
+        case RANDOM_: m_route_function =
+            &RoutingUnit::outportComputeFor<RANDOM_>; break;
+        case ADAPT_RAND_: m_route_function =
+            &RoutingUnit::outportComputeFor<ADAPT_RAND_>; break;
+        case WestFirst_: m_route_function =
+            &RoutingUnit::outportComputeFor<WestFirst_>; break;
+        case ADAPT_WestFirst_: m_route_function =
+            &RoutingUnit::outportComputeFor<ADAPT_WestFirst_>; break;
+        case CUSTOM_: m_route_function =
+            &RoutingUnit::outportComputeFor<CUSTOM_>; break;
+        case CONGESTION_: m_route_function =
+            &RoutingUnit::outportComputeFor<CONGESTION_>; break;
+        default: m_route_function =
+            &RoutingUnit::outportComputeFor<TABLE_>; break;
+    }
 }
 
 void
@@ -62,40 +153,54 @@ RoutingUnit::addWeight(int link_weight)
  * The routing table is populated during topology creation.
  * Routes can be biased via weight assignments in the topology file.
  * Correct weight assignments are critical to provide deadlock avoidance.
+ *
+ * The NetDest entries are scanned only once, in buildRouteTable(),
+ * into a list of minimum-weight outports per destination NI; a lookup
+ * then indexes that list.
  */
 
-int
-RoutingUnit::lookupRoutingTable(int vnet, NetDest msg_destination)
+void
+RoutingUnit::buildRouteTable(int num_nis)
 {
-
-//    std::cout << "using lookupRoutingTable " << std::endl;
-    int output_link = -1;
-    int min_weight = INFINITE_;
-    std::vector<int> output_link_candidates;
-    int num_candidates = 0;
-
-    // Identify the minimum weight among the candidate output links
+    // links that reach each destination, in link order
+    std::vector<std::vector<int> > dest_links(num_nis);
     for (int link = 0; link < m_routing_table.size(); link++) {
-        if (msg_destination.intersectionIsNotEmpty(m_routing_table[link])) {
-
-        if (m_weight_table[link] <= min_weight)
-            min_weight = m_weight_table[link];
+        for (NodeID dest : m_routing_table[link].getAllDest()) {
+            assert(dest < num_nis);
+            dest_links[dest].push_back(link);
         }
     }
 
-    // Collect all candidate output links with this minimum weight
-    for (int link = 0; link < m_routing_table.size(); link++) {
-        if (msg_destination.intersectionIsNotEmpty(m_routing_table[link])) {
-
-            if (m_weight_table[link] == min_weight) {
-
-                num_candidates++;
-                output_link_candidates.push_back(link);
+    GarnetNetwork *net_ptr = m_router->get_net_ptr();
+    m_num_nis = num_nis;
+    m_route_index.assign(1, 0);
+    m_route_candidates.clear();
+    for (int vnet = 0; vnet < m_router->get_num_vnets(); vnet++) {
+        for (int dest = 0; dest < num_nis; dest++) {
+            int min_weight = INFINITE_;
+            for (int link : dest_links[dest])
+                min_weight = std::min(min_weight, m_weight_table[link]);
+
+            for (int link : dest_links[dest]) {
+                if (m_weight_table[link] == min_weight) {
+                    m_route_candidates.push_back(link);
+                    if (net_ptr->isVNetOrdered(vnet))
+                        break;
+                }
             }
+            m_route_index.push_back(m_route_candidates.size());
         }
     }
+}
 
-    if (output_link_candidates.size() == 0) {
+int
+RoutingUnit::lookupRoutingTable(int vnet, int dest_ni)
+{
+    int entry = vnet * m_num_nis + dest_ni;
+    int first = m_route_index[entry];
+    int num_candidates = m_route_index[entry + 1] - first;
+
+    if (num_candidates == 0) {
         fatal("Fatal Error:: No Route exists from this Router.");
         exit(0);
     }
@@ -103,16 +208,18 @@ RoutingUnit::lookupRoutingTable(int vnet, NetDest msg_destination)
     // Randomly select any candidate output link
     int candidate = 0;
     if (!(m_router->get_net_ptr())->isVNetOrdered(vnet))
-        candidate = rand() % num_candidates;
+        candidate = m_router->get_rng().random(num_candidates);
 
-    output_link = output_link_candidates.at(candidate);
-    return output_link;
+    return m_route_candidates[first + candidate];
 }
 
 
 void
 RoutingUnit::addInDirection(PortDirection inport_dirn, int inport_idx)
 {
+    if (inport_idx >= m_inports_idx2dirn.size())
+        m_inports_idx2dirn.resize(inport_idx + 1, PortDirection_Unknown);
+
     m_inports_dirn2idx[inport_dirn] = inport_idx;
     m_inports_idx2dirn[inport_idx]  = inport_dirn;
 }
@@ -120,39 +227,37 @@ RoutingUnit::addInDirection(PortDirection inport_dirn, int inport_idx)
 void
 RoutingUnit::addOutDirection(PortDirection outport_dirn, int outport_idx)
 {
+    if (outport_idx >= m_outports_idx2dirn.size())
+        m_outports_idx2dirn.resize(outport_idx + 1, PortDirection_Unknown);
+
     m_outports_dirn2idx[outport_dirn] = outport_idx;
     m_outports_idx2dirn[outport_idx]  = outport_dirn;
 }
 
-// outportCompute() is called by the InputUnit
+// outportCompute() is called by the InputUnit through the
+// outportComputeFor() instance bound in init().
 // It calls the routing table by default.
 // A template for adaptive topology-specific routing algorithm
 // implementations using port directions rather than a static routing
 // table is provided here.
 
+template <RoutingAlgorithm algorithm>
 int
-RoutingUnit::outportCompute(RouteInfo route, int inport,
-                            PortDirection inport_dirn)
+RoutingUnit::outportComputeFor(const RouteInfo &route, int inport,
+                               PortDirection inport_dirn)
 {
     int outport = -1;
 
-    if (route.dest_router == m_router->get_id()) {
+    if (route.dest_router == m_my_id) {
 
         // Multiple NIs may be connected to this router,
         // all with output port direction = "Local"
         // Get exact outport id from table
-        outport = lookupRoutingTable(route.vnet, route.net_dest);
+        outport = lookupRoutingTable(route.vnet, route.dest_ni);
         return outport;
     }
 
-    // Routing Algorithm set in GarnetNetwork.py
-    // Can be over-ridden from command line using --routing-algorithm = 1
-    RoutingAlgorithm routing_algorithm =
-        (RoutingAlgorithm) m_router->get_net_ptr()->getRoutingAlgorithm();
-
-    switch (routing_algorithm) {
-        case TABLE_: outport =
-            lookupRoutingTable(route.vnet, route.net_dest); break;
+    switch (algorithm) {
         case XY_: outport =
             outportComputeXY(route, inport, inport_dirn); break;
         case RANDOM_: outport =
@@ -163,11 +268,13 @@ RoutingUnit::outportCompute(RouteInfo route, int inport,
             outportComputeWestFirst(route, inport, inport_dirn); break;
         case ADAPT_WestFirst_: outport =
             outportComputeAdaptWestFirst(route, inport, inport_dirn); break;
+        case CONGESTION_: outport =
+            outportComputeCongestion(route, inport, inport_dirn); break;
         // any custom algorithm
         case CUSTOM_: outport =
             outportComputeCustom(route, inport, inport_dirn); break;
         default: outport =
-            lookupRoutingTable(route.vnet, route.net_dest); break;
+            lookupRoutingTable(route.vnet, route.dest_ni); break;
     }
 
     assert(outport != -1);
@@ -178,30 +285,22 @@ RoutingUnit::outportCompute(RouteInfo route, int inport,
 // Only for reference purpose in a Mesh
 // By default Garnet uses the routing table
 int
-RoutingUnit::outportComputeXY(RouteInfo route,
+RoutingUnit::outportComputeXY(const RouteInfo &route,
                               int inport,
                               PortDirection inport_dirn)
 {
 //    std::cout << "Using XY-routing" << std::endl;
-    PortDirection outport_dirn = "Unknown";
-
-    int M5_VAR_USED num_rows = m_router->get_net_ptr()->getNumRows();
-    int num_cols = m_router->get_net_ptr()->getNumCols();
-    assert(num_rows > 0 && num_cols > 0);
+    PortDirection outport_dirn = PortDirection_Unknown;
 
-    int my_id = m_router->get_id();
-    int my_x = my_id % num_cols;
-    int my_y = my_id / num_cols;
+    // the mesh was checked and this router's coordinates cached in init()
+    int dest_x = route.dest_router % m_num_cols;
+    int dest_y = route.dest_router / m_num_cols;
 
-    int dest_id = route.dest_router;
-    int dest_x = dest_id % num_cols;
-    int dest_y = dest_id / num_cols;
+    int x_hops = abs(dest_x - m_my_x);
+    int y_hops = abs(dest_y - m_my_y);
 
-    int x_hops = abs(dest_x - my_x);
-    int y_hops = abs(dest_y - my_y);
-
-    bool x_dirn = (dest_x >= my_x);
-    bool y_dirn = (dest_y >= my_y);
+    bool x_dirn = (dest_x >= m_my_x);
+    bool y_dirn = (dest_y >= m_my_y);
 
     // already checked that in outportCompute() function
     assert(!(x_hops == 0 && y_hops == 0));
@@ -209,20 +308,20 @@ RoutingUnit::outportComputeXY(RouteInfo route,
     if (x_hops > 0) {
         if (x_dirn) {
             // assert(inport_dirn == "Local" || inport_dirn == "West");
-            outport_dirn = "East";
+            outport_dirn = PortDirection_East;
         } else {
             // assert(inport_dirn == "Local" || inport_dirn == "East");
-            outport_dirn = "West";
+            outport_dirn = PortDirection_West;
         }
     } else if (y_hops > 0) {
         if (y_dirn) {
             // "Local" or "South" or "West" or "East"
             // assert(inport_dirn != "North");
-            outport_dirn = "North";
+            outport_dirn = PortDirection_North;
         } else {
             // "Local" or "North" or "West" or "East"
             //assert(inport_dirn != "South");
-            outport_dirn = "South";
+            outport_dirn = PortDirection_South;
         }
     } else {
         // x_hops == 0 and y_hops == 0
@@ -236,29 +335,21 @@ RoutingUnit::outportComputeXY(RouteInfo route,
 
 // Random Routing
 int
-RoutingUnit::outportComputeRandom(RouteInfo route,
+RoutingUnit::outportComputeRandom(const RouteInfo &route,
                                   int inport,
                                   PortDirection inport_dirn)
 {
-    PortDirection outport_dirn = "Unknown";
-
-    int num_rows = m_router->get_net_ptr()->getNumRows();
-    int num_cols = m_router->get_net_ptr()->getNumCols();
-    assert(num_rows > 0 && num_cols > 0);
-
-    int my_id = m_router->get_id();
-    int my_x = my_id % num_cols;
-    int my_y = my_id / num_cols;
+    PortDirection outport_dirn = PortDirection_Unknown;
 
-    int dest_id = route.dest_router;
-    int dest_x = dest_id % num_cols;
-    int dest_y = dest_id / num_cols;
+    // the mesh was checked and this router's coordinates cached in init()
+    int dest_x = route.dest_router % m_num_cols;
+    int dest_y = route.dest_router / m_num_cols;
 
-    int x_hops = abs(dest_x - my_x);
-    int y_hops = abs(dest_y - my_y);
+    int x_hops = abs(dest_x - m_my_x);
+    int y_hops = abs(dest_y - m_my_y);
 
-    bool x_dirn = (dest_x >= my_x);
-    bool y_dirn = (dest_y >= my_y);
+    bool x_dirn = (dest_x >= m_my_x);
+    bool y_dirn = (dest_y >= m_my_y);
 
     // already checked that in outportCompute() function
     assert(!(x_hops == 0 && y_hops == 0));
@@ -266,29 +357,29 @@ RoutingUnit::outportComputeRandom(RouteInfo route,
     if (x_hops == 0)
     {
         if (y_dirn > 0)
-            outport_dirn = "North";
+            outport_dirn = PortDirection_North;
         else
-            outport_dirn = "South";
+            outport_dirn = PortDirection_South;
     }
     else if (y_hops == 0)
     {
         if (x_dirn > 0)
-            outport_dirn = "East";
+            outport_dirn = PortDirection_East;
         else
-            outport_dirn = "West";
+            outport_dirn = PortDirection_West;
     }
     else
     {
-        int rand = random() % 2;
+        int rand = m_router->get_rng().random(2);
 
         if (x_dirn && y_dirn) // Quadrant I
-            outport_dirn = rand ? "East" : "North";
+            outport_dirn = rand ? PortDirection_East : PortDirection_North;
         else if (!x_dirn && y_dirn) // Quadrant II
-            outport_dirn = rand ? "West" : "North";
+            outport_dirn = rand ? PortDirection_West : PortDirection_North;
         else if (!x_dirn && !y_dirn) // Quadrant III
-            outport_dirn = rand ? "West" : "South";
+            outport_dirn = rand ? PortDirection_West : PortDirection_South;
         else // Quadrant IV
-            outport_dirn = rand ? "East" : "South";
+            outport_dirn = rand ? PortDirection_East : PortDirection_South;
 
     }
 
@@ -297,29 +388,21 @@ RoutingUnit::outportComputeRandom(RouteInfo route,
 
 // Adaptive random routing algorithm...
 int
-RoutingUnit::outportComputeAdaptRand(RouteInfo route,
+RoutingUnit::outportComputeAdaptRand(const RouteInfo &route,
                                 int inport,
                                 PortDirection inport_dirn)
 {
-    PortDirection outport_dirn = "Unknown";
-
-    int num_rows = m_router->get_net_ptr()->getNumRows();
-    int num_cols = m_router->get_net_ptr()->getNumCols();
-    assert(num_rows > 0 && num_cols > 0);
-
-    int my_id = m_router->get_id();
-    int my_x = my_id % num_cols;
-    int my_y = my_id / num_cols;
+    PortDirection outport_dirn = PortDirection_Unknown;
 
-    int dest_id = route.dest_router;
-    int dest_x = dest_id % num_cols;
-    int dest_y = dest_id / num_cols;
+    // the mesh was checked and this router's coordinates cached in init()
+    int dest_x = route.dest_router % m_num_cols;
+    int dest_y = route.dest_router / m_num_cols;
 
-    int x_hops = abs(dest_x - my_x);
-    int y_hops = abs(dest_y - my_y);
+    int x_hops = abs(dest_x - m_my_x);
+    int y_hops = abs(dest_y - m_my_y);
 
-    bool x_dirn = (dest_x >= my_x);
-    bool y_dirn = (dest_y >= my_y);
+    bool x_dirn = (dest_x >= m_my_x);
+    bool y_dirn = (dest_y >= m_my_y);
 
     // already checked that in outportCompute() function
     assert(!(x_hops == 0 && y_hops == 0));
@@ -327,93 +410,68 @@ RoutingUnit::outportComputeAdaptRand(RouteInfo route,
     if (x_hops == 0)
     {
         if (y_dirn > 0)
-            outport_dirn = "North";
+            outport_dirn = PortDirection_North;
         else
-            outport_dirn = "South";
+            outport_dirn = PortDirection_South;
     }
     else if (y_hops == 0)
     {
         if (x_dirn > 0)
-            outport_dirn = "East";
+            outport_dirn = PortDirection_East;
         else
-            outport_dirn = "West";
+            outport_dirn = PortDirection_West;
     }
     else
     {
         // whichever router has more free VCs route there
-        int rand = random() % 2;
-        Router *router_Est, *router_Wst, *router_South, *router_Nrth;
+        int rand = m_router->get_rng().random(2);
         if (x_dirn && y_dirn) {// Quadrant I
             // check for routers in both 'East' and 'North'
             // direction
-            router_Est = m_router->get_net_ptr()->\
-                get_downstreamRouter( "East", m_router->get_id());
-            router_Nrth = m_router->get_net_ptr()->\
-                get_downstreamRouter( "North", m_router->get_id());
-            // caution: 'dirn_' is the direction of inport of
-            // downstream router
-            int freeVC_East = router_Est->get_numFreeVC("West");
-            int freeVC_North = router_Nrth->get_numFreeVC("South");
+            int freeVC_East = numFreeVC(PortDirection_East);
+            int freeVC_North = numFreeVC(PortDirection_North);
 
             if (freeVC_East > freeVC_North)
-                outport_dirn = "East";
+                outport_dirn = PortDirection_East;
             else if (freeVC_North > freeVC_East)
-                outport_dirn = "North";
+                outport_dirn = PortDirection_North;
             else
-                outport_dirn = rand ? "East" : "North";
+                outport_dirn = rand ? PortDirection_East : PortDirection_North;
 
         }
         else if (!x_dirn && y_dirn) {// Quadrant II
-
-            router_Wst = m_router->get_net_ptr()->\
-                get_downstreamRouter( "West", m_router->get_id());
-            router_Nrth = m_router->get_net_ptr()->\
-                get_downstreamRouter( "North", m_router->get_id());
-
-            int freeVC_West = router_Wst->get_numFreeVC("East");
-            int freeVC_North = router_Nrth->get_numFreeVC("South");
+            int freeVC_West = numFreeVC(PortDirection_West);
+            int freeVC_North = numFreeVC(PortDirection_North);
 
             if (freeVC_North > freeVC_West)
-                outport_dirn = "North";
+                outport_dirn = PortDirection_North;
             else if (freeVC_West > freeVC_North)
-                outport_dirn = "West";
+                outport_dirn = PortDirection_West;
             else
-                outport_dirn = rand ? "West" : "North";
+                outport_dirn = rand ? PortDirection_West : PortDirection_North;
 
         }
         else if (!x_dirn && !y_dirn) {// Quadrant III
-
-            router_Wst = m_router->get_net_ptr()->\
-                get_downstreamRouter( "West", m_router->get_id());
-            router_South = m_router->get_net_ptr()->\
-                get_downstreamRouter( "South", m_router->get_id());
-
-            int freeVC_West = router_Wst->get_numFreeVC("East");
-            int freeVC_South = router_South->get_numFreeVC("North");
+            int freeVC_West = numFreeVC(PortDirection_West);
+            int freeVC_South = numFreeVC(PortDirection_South);
 
             if (freeVC_South > freeVC_West)
-                outport_dirn = "South";
+                outport_dirn = PortDirection_South;
             else if (freeVC_West > freeVC_South)
-                outport_dirn = "West";
+                outport_dirn = PortDirection_West;
             else
-                outport_dirn = rand ? "West" : "South";
+                outport_dirn = rand ? PortDirection_West : PortDirection_South;
         }
         else {// Quadrant IV
-
-            router_Est = m_router->get_net_ptr()->\
-                get_downstreamRouter( "East", m_router->get_id());
-            router_South = m_router->get_net_ptr()->\
-                get_downstreamRouter( "South", m_router->get_id());
-
-            int freeVC_East = router_Est->get_numFreeVC("West");
-            int freeVC_South = router_South->get_numFreeVC("North");
+            int freeVC_East = numFreeVC(PortDirection_East);
+            int freeVC_South = numFreeVC(PortDirection_South);
 
             if (freeVC_South > freeVC_East)
-                outport_dirn = "South";
+                outport_dirn = PortDirection_South;
             else if (freeVC_East > freeVC_South)
-                outport_dirn = "East";
+                outport_dirn = PortDirection_East;
             else
-                outport_dirn = rand ? "East" : "South";
+                outport_dirn = rand ? PortDirection_East : PortDirection_South;
         }
     }
 
@@ -422,60 +480,52 @@ RoutingUnit::outportComputeAdaptRand(RouteInfo route,
 
 // West-First routing algorithm...
 int
-RoutingUnit::outportComputeWestFirst(RouteInfo route,
+RoutingUnit::outportComputeWestFirst(const RouteInfo &route,
                                 int inport,
                                 PortDirection inport_dirn)
 {
-    PortDirection outport_dirn = "Unknown";
-
-    int num_rows = m_router->get_net_ptr()->getNumRows();
-    int num_cols = m_router->get_net_ptr()->getNumCols();
-    assert(num_rows > 0 && num_cols > 0);
+    PortDirection outport_dirn = PortDirection_Unknown;
 
-    int my_id = m_router->get_id();
-    int my_x = my_id % num_cols;
-    int my_y = my_id / num_cols;
+    // the mesh was checked and this router's coordinates cached in init()
+    int dest_x = route.dest_router % m_num_cols;
+    int dest_y = route.dest_router / m_num_cols;
 
-    int dest_id = route.dest_router;
-    int dest_x = dest_id % num_cols;
-    int dest_y = dest_id / num_cols;
+    int x_hops = abs(dest_x - m_my_x);
+    int y_hops = abs(dest_y - m_my_y);
 
-    int x_hops = abs(dest_x - my_x);
-    int y_hops = abs(dest_y - my_y);
-
-    bool x_dirn = (dest_x >= my_x);
-    bool y_dirn = (dest_y >= my_y);
+    bool x_dirn = (dest_x >= m_my_x);
+    bool y_dirn = (dest_y >= m_my_y);
 
     // already checked that in outportCompute() function
     assert(!(x_hops == 0 && y_hops == 0));
 
-    int rand = random() % 2;
+    int rand = m_router->get_rng().random(2);
 
     if (x_hops == 0)
     {
         if (y_dirn > 0)
-            outport_dirn = "North";
+            outport_dirn = PortDirection_North;
         else
-            outport_dirn = "South";
+            outport_dirn = PortDirection_South;
     }
     else if (y_hops == 0)
     {
         if (x_dirn > 0)
-            outport_dirn = "East";
+            outport_dirn = PortDirection_East;
         else
-            outport_dirn = "West";
+            outport_dirn = PortDirection_West;
     }
     else if (!(x_dirn))
     {
-        outport_dirn = "West";
+        outport_dirn = PortDirection_West;
     }
     else if (y_dirn)
     {
-        outport_dirn = rand ? "East" : "North";
+        outport_dirn = rand ? PortDirection_East : PortDirection_North;
     }
     else if (!(y_dirn))
     {
-        outport_dirn = rand ? "East" : "South";
+        outport_dirn = rand ? PortDirection_East : PortDirection_South;
     }
 
     return m_outports_dirn2idx[outport_dirn];
@@ -485,87 +535,68 @@ RoutingUnit::outportComputeWestFirst(RouteInfo route,
 
 // Adaptive West-First routing algorithm...
 int
-RoutingUnit::outportComputeAdaptWestFirst(RouteInfo route,
+RoutingUnit::outportComputeAdaptWestFirst(const RouteInfo &route,
                                 int inport,
                                 PortDirection inport_dirn)
 {
-    PortDirection outport_dirn = "Unknown";
-
-    int num_rows = m_router->get_net_ptr()->getNumRows();
-    int num_cols = m_router->get_net_ptr()->getNumCols();
-    assert(num_rows > 0 && num_cols > 0);
+    PortDirection outport_dirn = PortDirection_Unknown;
 
-    int my_id = m_router->get_id();
-    int my_x = my_id % num_cols;
-    int my_y = my_id / num_cols;
+    // the mesh was checked and this router's coordinates cached in init()
+    int dest_x = route.dest_router % m_num_cols;
+    int dest_y = route.dest_router / m_num_cols;
 
-    int dest_id = route.dest_router;
-    int dest_x = dest_id % num_cols;
-    int dest_y = dest_id / num_cols;
+    int x_hops = abs(dest_x - m_my_x);
+    int y_hops = abs(dest_y - m_my_y);
 
-    int x_hops = abs(dest_x - my_x);
-    int y_hops = abs(dest_y - my_y);
-
-    bool x_dirn = (dest_x >= my_x);
-    bool y_dirn = (dest_y >= my_y);
+    bool x_dirn = (dest_x >= m_my_x);
+    bool y_dirn = (dest_y >= m_my_y);
 
     // already checked that in outportCompute() function
     assert(!(x_hops == 0 && y_hops == 0));
-    int rand = random() % 2;
-    Router *router_Est, *router_South, *router_Nrth;
+    int rand = m_router->get_rng().random(2);
 
     if (x_hops == 0)
     {
         if (y_dirn > 0)
-            outport_dirn = "North";
+            outport_dirn = PortDirection_North;
         else
-            outport_dirn = "South";
+            outport_dirn = PortDirection_South;
     }
     else if (y_hops == 0)
     {
         if (x_dirn > 0)
-            outport_dirn = "East";
+            outport_dirn = PortDirection_East;
         else
-            outport_dirn = "West";
+            outport_dirn = PortDirection_West;
     }
     else if (!(x_dirn))
     {
-        outport_dirn = "West";
+        outport_dirn = PortDirection_West;
     }
     else if (y_dirn)
     {
-        router_Est = m_router->get_net_ptr()->\
-            get_downstreamRouter( "East", m_router->get_id());
-        router_Nrth = m_router->get_net_ptr()->\
-            get_downstreamRouter( "North", m_router->get_id());
-        // caution: 'dirn_' is the direction of inport of
-        // downstream router
-        int freeVC_East = router_Est->get_numFreeVC("West");
-        int freeVC_North = router_Nrth->get_numFreeVC("South");
+        int freeVC_East = numFreeVC(PortDirection_East);
+        int freeVC_North = numFreeVC(PortDirection_North);
 
         if (freeVC_East > freeVC_North)
-            outport_dirn = "East";
+            outport_dirn = PortDirection_East;
         else if (freeVC_North > freeVC_East)
-            outport_dirn = "North";
+            outport_dirn = PortDirection_North;
         else
-            outport_dirn = rand ? "East" : "North";
+            outport_dirn = rand ? PortDirection_East : PortDirection_North;
     }
     else if (!(y_dirn))
     {
-        router_Est = m_router->get_net_ptr()->\
-            get_downstreamRouter( "East", m_router->get_id());
-        router_South = m_router->get_net_ptr()->\
-            get_downstreamRouter( "South", m_router->get_id());
 
-        int freeVC_East = router_Est->get_numFreeVC("West");
-        int freeVC_South = router_South->get_numFreeVC("North");
+        int freeVC_East = numFreeVC(PortDirection_East);
+        int freeVC_South = numFreeVC(PortDirection_South);
 
         if (freeVC_South > freeVC_East)
-            outport_dirn = "South";
+            outport_dirn = PortDirection_South;
         else if (freeVC_East > freeVC_South)
-            outport_dirn = "East";
+            outport_dirn = PortDirection_East;
         else
-            outport_dirn = rand ? "East" : "South";
+            outport_dirn = rand ? PortDirection_East : PortDirection_South;
 
     }
 
@@ -573,34 +604,76 @@ RoutingUnit::outportComputeAdaptWestFirst(RouteInfo route,
 
 }
 
+// Congestion-aware adaptive routing, DyXY style: when both the X and
+// the Y direction are productive, take the one whose outport reports
+// less congestion (local credits, plus the regional estimate unless
+// congestion_regional is off); ties are broken at random. Without
+// SWAP, packets heading west go west first (west-first turn model),
+// which keeps the selection deadlock free without extra VCs.
 int
-RoutingUnit::numFreeVC(PortDirection dirn_/*outport_dirn of this router*/)
+RoutingUnit::outportComputeCongestion(const RouteInfo &route,
+                                      int inport,
+                                      PortDirection inport_dirn)
 {
-    Router* downstreamRouter;
-//    cout << "my_id: " << m_router->get_id() << endl;
-    downstreamRouter = m_router->get_net_ptr()->\
-            get_downstreamRouter( dirn_, m_router->get_id());
+    PortDirection outport_dirn = PortDirection_Unknown;
+
+    // the mesh was checked and this router's coordinates cached in init()
+    int dest_x = route.dest_router % m_num_cols;
+    int dest_y = route.dest_router / m_num_cols;
+
+    int x_hops = abs(dest_x - m_my_x);
+    int y_hops = abs(dest_y - m_my_y);
+
+    bool x_dirn = (dest_x >= m_my_x);
+    bool y_dirn = (dest_y >= m_my_y);
 
-    if (downstreamRouter == NULL)
+    // already checked that in outportCompute() function
+    assert(!(x_hops == 0 && y_hops == 0));
+
+    if (x_hops == 0) {
+        outport_dirn = y_dirn ? PortDirection_North : PortDirection_South;
+    } else if (y_hops == 0) {
+        outport_dirn = x_dirn ? PortDirection_East : PortDirection_West;
+    } else if (!x_dirn && !m_router->get_net_ptr()->isEnableInterswap()) {
+        outport_dirn = PortDirection_West;
+    } else {
+        PortDirection x_out =
+            x_dirn ? PortDirection_East : PortDirection_West;
+        PortDirection y_out =
+            y_dirn ? PortDirection_North : PortDirection_South;
+        std::vector<OutputUnit *> &output_unit =
+            m_router->get_outputUnit_ref();
+        int x_congestion =
+            output_unit[m_outports_dirn2idx[x_out]]->get_congestion();
+        int y_congestion =
+            output_unit[m_outports_dirn2idx[y_out]]->get_congestion();
+
+        if (x_congestion < y_congestion)
+            outport_dirn = x_out;
+        else if (y_congestion < x_congestion)
+            outport_dirn = y_out;
+        else
+            outport_dirn = m_router->get_rng().random(2) ? x_out : y_out;
+    }
+
+    return m_outports_dirn2idx[outport_dirn];
+}
+
+int
+RoutingUnit::numFreeVC(PortDirection dirn_/*outport_dirn of this router*/)
+{
+    InputUnit *unit = m_downstream_unit[dirn_];
+    if (unit == NULL)
         return 0; // effectively there's no output-port in that dirn
 
-    if( dirn_ == "North")
-            return (downstreamRouter->get_numFreeVC("South"));
-    else if ( dirn_ == "East")
-        return (downstreamRouter->get_numFreeVC("West"));
-    else if ( dirn_ == "West")
-        return (downstreamRouter->get_numFreeVC("East"));
-    else if (dirn_ == "South")
-        return (downstreamRouter->get_numFreeVC("North"));
-    else
-        assert(0); // shouldn't come here..
+    return unit->get_numFreeVC(unit->get_direction());
 }
 
 
 // Template for implementing custom routing algorithm
 // using port directions. (Example adaptive)
 int
-RoutingUnit::outportComputeCustom(RouteInfo route,
+RoutingUnit::outportComputeCustom(const RouteInfo &route,
                                  int inport,
                                  PortDirection inport_dirn)
 {
@@ -47,70 +47,117 @@ class RoutingUnit
 {
   public:
     RoutingUnit(Router *router);
-    int outportCompute(RouteInfo route,
-                      int inport,
-                      PortDirection inport_dirn);
+
+    // Bind the route computation of the configured routing algorithm
+    // and cache this router's mesh coordinates and downstream input
+    // units; called from Router::init(), after the topology is built
+    void init();
+
+    inline int
+    outportCompute(const RouteInfo &route,
+                   int inport,
+                   PortDirection inport_dirn)
+    {
+        return (this->*m_route_function)(route, inport, inport_dirn);
+    }
 
     // Topology-agnostic Routing Table based routing (default)
     void addRoute(const NetDest& routing_table_entry);
     void addWeight(int link_weight);
 
+    // Precompute the candidate outports of every (vnet, destination
+    // NI) from the routing table; called once the topology is built
+    void buildRouteTable(int num_nis);
+
     // get output port from routing table
-    int  lookupRoutingTable(int vnet, NetDest net_dest);
+    int  lookupRoutingTable(int vnet, int dest_ni);
 
     // Topology-specific direction based routing
     void addInDirection(PortDirection inport_dirn, int inport);
     void addOutDirection(PortDirection outport_dirn, int outport);
 
     // Routing for Mesh
-    int outportComputeXY(RouteInfo route,
+    int outportComputeXY(const RouteInfo &route,
                          int inport,
                          PortDirection inport_dirn);
 
     int
-    outportComputeRandom(RouteInfo route,
+    outportComputeRandom(const RouteInfo &route,
                              int inport,
                              PortDirection inport_dirn);
 
     int
-    outportComputeAdaptRand(RouteInfo route,
+    outportComputeAdaptRand(const RouteInfo &route,
                          int inport,
                          PortDirection inport_dirn);
     int
-    outportComputeWestFirst(RouteInfo route,
+    outportComputeWestFirst(const RouteInfo &route,
                                     int inport,
                                     PortDirection inport_dirn);
 
     int
-    outportComputeAdaptWestFirst(RouteInfo route,
+    outportComputeAdaptWestFirst(const RouteInfo &route,
                          int inport,
                          PortDirection inport_dirn);
 
+    // Congestion-aware minimal adaptive routing (CONGESTION_)
     int
-    outportComputeXY_Deflection(RouteInfo route,
+    outportComputeCongestion(const RouteInfo &route,
+                             int inport,
+                             PortDirection inport_dirn);
+
+    int
+    outportComputeXY_Deflection(const RouteInfo &route,
                          int inport,
                          PortDirection inport_dirn);
 
 
     // Custom Routing Algorithm using Port Directions
-    int outportComputeCustom(RouteInfo route,
+    int outportComputeCustom(const RouteInfo &route,
                              int inport,
                              PortDirection inport_dirn);
     int numFreeVC(PortDirection dirn);
 
   public:
-    // Inport and Outport direction to idx maps
-    std::map<PortDirection, int> m_inports_dirn2idx;
-    std::map<int, PortDirection> m_inports_idx2dirn;
-    std::map<int, PortDirection> m_outports_idx2dirn;
-    std::map<PortDirection, int> m_outports_dirn2idx;
+    // Inport and Outport direction to idx tables
+    // dirn2idx is indexed by PortDirection (-1 if no such port),
+    // idx2dirn by port id.
+    std::vector<int> m_inports_dirn2idx;
+    std::vector<PortDirection> m_inports_idx2dirn;
+    std::vector<PortDirection> m_outports_idx2dirn;
+    std::vector<int> m_outports_dirn2idx;
 
   private:
     Router *m_router;
 
+    // outportCompute() for one routing algorithm: the switch on the
+    // template parameter folds away and the algorithm is inlined
+    template <RoutingAlgorithm algorithm>
+    int outportComputeFor(const RouteInfo &route, int inport,
+                          PortDirection inport_dirn);
+    typedef int (RoutingUnit::*RouteFunction)(const RouteInfo &, int,
+                                              PortDirection);
+    RouteFunction m_route_function;
+
+    // Cached by init(): router id, mesh columns and coordinates (-1
+    // unless the topology is a mesh), and per outport direction the
+    // input unit of the downstream router (NULL for none or an NI)
+    int m_my_id;
+    int m_num_cols;
+    int m_my_x, m_my_y;
+    std::vector<InputUnit *> m_downstream_unit;
+
     // Routing Table
     std::vector<NetDest> m_routing_table;
     std::vector<int> m_weight_table;
+
+    // Minimum-weight outports per (vnet, destination NI), flattened:
+    // entry i = vnet * m_num_nis + dest_ni owns
+    // m_route_candidates[m_route_index[i] .. m_route_index[i + 1]).
+    // Ordered vnets keep only the first candidate.
+    int m_num_nis;
+    std::vector<int> m_route_index;
+    std::vector<int> m_route_candidates;
 };
 
 #endif // __MEM_RUBY_NETWORK_GARNET_ROUTING_UNIT_HH__
@@ -33,6 +33,7 @@
 
 #include "mem/ruby/network/garnet2.0/SwitchAllocator.hh"
 
+#include "base/bitfield.hh"
 #include "debug/RubyNetwork.hh"
 #include "mem/ruby/network/garnet2.0/GarnetNetwork.hh"
 #include "mem/ruby/network/garnet2.0/InputUnit.hh"
@@ -65,6 +66,14 @@ SwitchAllocator::init()
     m_port_requests.resize(m_num_outports);
     m_vc_winners.resize(m_num_outports);
 
+    m_bitmask_alloc = m_router->get_net_ptr()->isBitmaskSwAlloc();
+    if (m_bitmask_alloc) {
+        fatal_if(m_num_inports > 64, "Bitmask switch allocator supports "
+                 "at most 64 inports, router %d has %d",
+                 m_router->get_id(), m_num_inports);
+        m_port_request_mask.resize(m_num_outports, 0);
+    }
+
     for (int i = 0; i < m_num_inports; i++) {
         m_round_robin_invc[i] = 0;
     }
@@ -94,7 +103,11 @@ void
 SwitchAllocator::wakeup()
 {
     arbitrate_inports(); // First stage of allocation
-    arbitrate_outports(); // Second stage of allocation
+    // Second stage of allocation
+    if (m_bitmask_alloc)
+        arbitrate_outports_bitmask();
+    else
+        arbitrate_outports();
 
     clear_request_vector();
     check_for_wakeup();
@@ -116,9 +129,27 @@ SwitchAllocator::arbitrate_inports()
     // Select a VC from each input in a round robin manner
     // Independent arbiter at each input port
     for (int inport = 0; inport < m_num_inports; inport++) {
-        int invc = m_round_robin_invc[inport];
-
-        for (int invc_iter = 0; invc_iter < m_num_vcs; invc_iter++) {
+        // Only VCs holding flits can take part in SA
+        uint64_t active_vcs = m_input_unit[inport]->get_active_vcs();
+        if (active_vcs == 0)
+            continue;
+
+        // Visit the non-empty VCs in round robin order starting at
+        // m_round_robin_invc: the set bits at or above it first,
+        // then the ones below it.
+        int rr_vc = m_round_robin_invc[inport];
+        uint64_t upper_vcs = active_vcs & (~0ULL << rr_vc);
+        uint64_t lower_vcs = active_vcs & ~upper_vcs;
+
+        while (upper_vcs | lower_vcs) {
+            int invc;
+            if (upper_vcs) {
+                invc = findLsbSet(upper_vcs);
+                upper_vcs &= upper_vcs - 1;
+            } else {
+                invc = findLsbSet(lower_vcs);
+                lower_vcs &= lower_vcs - 1;
+            }
 
             if (m_input_unit[inport]->need_stage(invc, SA_,
                 m_router->curCycle())) {
@@ -130,10 +161,9 @@ SwitchAllocator::arbitrate_inports()
                 // int  outport = m_input_unit[inport]->get_outport(invc);
                 int  outport =
                     m_input_unit[inport]->peekTopFlit(invc)->get_outport();
-                // this is done for multi flit packet.. HEAD/HEAD_TAIL
-                // will have outvc = -1
-                // set in vc_allocate
-                int outvc = -1;
+                // HEAD/HEAD_TAIL will have outvc = -1; BODY/TAIL flits
+                // use the outvc their head got in vc_allocate
+                int outvc = m_input_unit[inport]->get_outvc(invc);
 
                 #if (MY_PRINT)
                     cout << "Inport: " << inport <<" invc: "<< invc <<
@@ -146,7 +176,10 @@ SwitchAllocator::arbitrate_inports()
 
                 if (make_request) {
                     m_input_arbiter_activity++;
-                    m_port_requests[outport][inport] = true;
+                    if (m_bitmask_alloc)
+                        m_port_request_mask[outport] |= (1ULL << inport);
+                    else
+                        m_port_requests[outport][inport] = true;
                     m_vc_winners[outport][inport]= invc;
 
                     // Update Round Robin pointer
@@ -159,11 +192,8 @@ SwitchAllocator::arbitrate_inports()
                 }
             }
             // control will come here when it fails for 'making request'
-            // for given invc of given outport. In which case try next vc
-            // if available for the same outport.
-            invc++;
-            if (invc >= m_num_vcs)
-                invc = 0;
+            // for given invc of given outport. In which case try next
+            // non-empty vc if available for the same outport.
         }
     }
     // check if this inport is same as one pointed by the swap_ptr
@@ -198,130 +228,165 @@ SwitchAllocator::arbitrate_outports()
 
             // inport has a request this cycle for outport
             if (m_port_requests[outport][inport]) {
+                grant_outport(outport, inport);
+                break; // got a input winner for this outport
+            }
 
-                // grant this outport to this inport
-                int invc = m_vc_winners[outport][inport];
+            inport++;
+            if (inport >= m_num_inports)
+                inport = 0;
+        }
+    }
+}
 
-                int outvc = m_input_unit[inport]->get_outvc(invc);
-                assert(outvc == -1);
-                if (outvc == -1) {
-                    // VC Allocation - select any free VC from outport
-                    outvc = vc_allocate(outport, inport, invc);
-                }
+/*
+ * Same as arbitrate_outports(), with the requests for each outport kept
+ * as a bitmask of inports. The round robin search for the first
+ * requesting inport at or after m_round_robin_inport becomes a
+ * find-first-set on the rotated mask, so grants are identical.
+ */
 
-                if (this->m_router->get_net_ptr()->isEnableInterswap()) {
-                    if (m_input_unit[inport]->peekTopFlit(invc)\
-                                            ->get_RoutedSwap() == true) {
-                        // this means the Routed Swap flit is leaving the router
-                        if(m_router->get_net_ptr()->m_no_is_swap == 0) {
-                            assert(m_router->is_swap == true);
-                        }
-                        #if (MY_PRINT)
-                            cout << "Routed flit has made forward progress "\
-                                    "via switchAllocator clearing both "\
-                                    "'is_swap' bit of router as well as "\
-                                    "'routedSwap' of flit" << endl;
-                        #endif
-                        // clear both bits
-                        // because flit is makig forward progress
-                        // using switch (normal behavior)
-                        m_input_unit[inport]->peekTopFlit(invc)\
-                                            ->unset_RoutedSwap();
-                        m_router->is_swap = false;
-                        // 'send_routedSwap' flag cannot be high here...
-                        // it's been taken care of in Router::wakeup()
-                        assert(m_router->get_send_routedSwap() == false);
-                    }
-                }
+void
+SwitchAllocator::arbitrate_outports_bitmask()
+{
+    for (int outport = 0; outport < m_num_outports; outport++) {
+        uint64_t requests = m_port_request_mask[outport];
+        if (requests == 0)
+            continue;
 
-                // remove flit from Input VC
-                flit *t_flit = m_input_unit[inport]->getTopFlit(invc);
-
-                if (m_router->get_net_ptr()->isEnableInterswap()) {
-                    // if the same  flit which is pointed by `swap_ptr` leaves
-                    // via switch allocation... movSwapPtr() is all empty then
-                    // API will automatically turn the `swap_ptr` off
-                    if ((inport == m_router->swap_ptr.inport) &&
-                        (invc == m_router->swap_ptr.vcid)) {
-                        m_router->movSwapPtr();
-                    }
-                }
+        int rr_inport = m_round_robin_inport[outport];
+        uint64_t upper_requests = requests & (~0ULL << rr_inport);
+        int inport = findLsbSet(upper_requests ? upper_requests : requests);
 
-                DPRINTF(RubyNetwork, "SwitchAllocator at Router %d "
-                                     "granted outvc %d at outport %s "
-                                     "to invc %d at inport %s to flit %s at "
-                                     "time: %lld\n",
-                        m_router->get_id(), outvc,
-                        m_router->getPortDirectionName(
-                            m_output_unit[outport]->get_direction()),
-                        invc,
-                        m_router->getPortDirectionName(
-                            m_input_unit[inport]->get_direction()),
-                            *t_flit,
-                        m_router->curCycle());
-
-
-                // Update outport field in the flit since this is
-                // used by CrossbarSwitch code to send it out of
-                // correct outport.
-                // Note: post route compute in InputUnit,
-                // outport is updated in VC, but not in flit
-
-                t_flit->set_outport(outport);
-                PortDirection dirn = m_output_unit[outport]->get_direction();
-                t_flit->set_outport_dir(dirn);
-
-                // set outvc (i.e., invc for next hop) in flit
-                // (This was updated in VC by vc_allocate, but not in flit)
-                t_flit->set_vc(outvc);
-
-                // decrement credit in outvc
-                m_output_unit[outport]->decrement_credit(outvc);
-
-                // flit ready for Switch Traversal
-                t_flit->advance_stage(ST_, m_router->curCycle());
-                // This initializes the 'm_switch_buffer' vector of
-                // class CrossbarSwitch.
-                m_router->grant_switch(inport, t_flit);
-                // this is for stats
-                m_output_arbiter_activity++;
-
-                if ((t_flit->get_type() == TAIL_) ||
-                    t_flit->get_type() == HEAD_TAIL_) {
-
-                    assert(!(m_input_unit[inport]->isReady(invc,
-                        m_router->curCycle())));
-
-                    // Free this VC
-                    m_input_unit[inport]->set_vc_idle(invc,
-                        m_router->curCycle());
-                    // Send a credit back
-                    // along with the information that this VC is now idle
-                    m_input_unit[inport]->increment_credit(invc, true,
-                        m_router->curCycle());
-                } else {
-                    // Send a credit back
-                    // but do not indicate that the VC is idle
-                    m_input_unit[inport]->increment_credit(invc, false,
-                        m_router->curCycle());
-                }
+        grant_outport(outport, inport);
+    }
+}
 
-                // remove this request
-                m_port_requests[outport][inport] = false;
+/*
+ * Grant outport to the input VC selected by inport in SA-I:
+ * allocate an output VC, read the flit out of the input VC, send it to
+ * the CrossbarSwitch and return a credit upstream.
+ */
+
+void
+SwitchAllocator::grant_outport(int outport, int inport)
+{
+    // grant this outport to this inport
+    int invc = m_vc_winners[outport][inport];
 
-                // Update Round Robin pointer
-                m_round_robin_inport[outport]++;
-                if (m_round_robin_inport[outport] >= m_num_inports)
-                    m_round_robin_inport[outport] = 0;
+    int outvc = m_input_unit[inport]->get_outvc(invc);
+    if (outvc == -1) {
+        // VC Allocation - select any free VC from outport
+        outvc = vc_allocate(outport, inport, invc);
+    }
 
-                break; // got a input winner for this outport
+    if (this->m_router->get_net_ptr()->isEnableInterswap()) {
+        if (m_input_unit[inport]->peekTopFlit(invc)\
+                                ->get_RoutedSwap() == true) {
+            // this means the Routed Swap flit is leaving the router
+            if(m_router->get_net_ptr()->m_no_is_swap == 0) {
+                assert(m_router->is_swap == true);
             }
+            #if (MY_PRINT)
+                cout << "Routed flit has made forward progress "\
+                        "via switchAllocator clearing both "\
+                        "'is_swap' bit of router as well as "\
+                        "'routedSwap' of flit" << endl;
+            #endif
+            // clear both bits
+            // because flit is makig forward progress
+            // using switch (normal behavior)
+            m_input_unit[inport]->peekTopFlit(invc)\
+                                ->unset_RoutedSwap();
+            m_router->is_swap = false;
+            // 'send_routedSwap' flag cannot be high here...
+            // it's been taken care of in Router::wakeup()
+            assert(m_router->get_send_routedSwap() == false);
+        }
+    }
 
-            inport++;
-            if (inport >= m_num_inports)
-                inport = 0;
+    // remove flit from Input VC
+    flit *t_flit = m_input_unit[inport]->getTopFlit(invc);
+
+    if (m_router->get_net_ptr()->isEnableInterswap()) {
+        // if the same  flit which is pointed by `swap_ptr` leaves
+        // via switch allocation... movSwapPtr() is all empty then
+        // API will automatically turn the `swap_ptr` off
+        if ((inport == m_router->swap_ptr.inport) &&
+            (invc == m_router->swap_ptr.vcid)) {
+            m_router->movSwapPtr();
         }
     }
+
+    DPRINTF(RubyNetwork, "SwitchAllocator at Router %d "
+                         "granted outvc %d at outport %s "
+                         "to invc %d at inport %s to flit %s at "
+                         "time: %lld\n",
+            m_router->get_id(), outvc,
+            m_router->getPortDirectionName(
+                m_output_unit[outport]->get_direction()),
+            invc,
+            m_router->getPortDirectionName(
+                m_input_unit[inport]->get_direction()),
+                *t_flit,
+            m_router->curCycle());
+
+
+    // Update outport field in the flit since this is
+    // used by CrossbarSwitch code to send it out of
+    // correct outport.
+    // Note: post route compute in InputUnit,
+    // outport is updated in VC, but not in flit
+
+    t_flit->set_outport(outport);
+    PortDirection dirn = m_output_unit[outport]->get_direction();
+    t_flit->set_outport_dir(dirn);
+
+    // set outvc (i.e., invc for next hop) in flit
+    // (This was updated in VC by vc_allocate, but not in flit)
+    t_flit->set_vc(outvc);
+
+    // decrement credit in outvc
+    m_output_unit[outport]->decrement_credit(outvc);
+
+    // flit ready for Switch Traversal
+    t_flit->advance_stage(ST_, m_router->curCycle());
+    // This initializes the 'm_switch_buffer' vector of
+    // class CrossbarSwitch.
+    m_router->grant_switch(inport, t_flit);
+    // this is for stats
+    m_output_arbiter_activity++;
+
+    if ((t_flit->get_type() == TAIL_) ||
+        t_flit->get_type() == HEAD_TAIL_) {
+
+        assert(!(m_input_unit[inport]->isReady(invc,
+            m_router->curCycle())));
+
+        // Free this VC
+        m_input_unit[inport]->set_vc_idle(invc,
+            m_router->curCycle());
+        // Send a credit back
+        // along with the information that this VC is now idle
+        m_input_unit[inport]->increment_credit(invc, true,
+            m_router->curCycle());
+    } else {
+        // Send a credit back
+        // but do not indicate that the VC is idle
+        m_input_unit[inport]->increment_credit(invc, false,
+            m_router->curCycle());
+    }
+
+    // remove this request
+    if (m_bitmask_alloc)
+        m_port_request_mask[outport] &= ~(1ULL << inport);
+    else
+        m_port_requests[outport][inport] = false;
+
+    // Update Round Robin pointer
+    m_round_robin_inport[outport]++;
+    if (m_round_robin_inport[outport] >= m_num_inports)
+        m_round_robin_inport[outport] = 0;
 }
 
 /*
@@ -344,7 +409,6 @@ SwitchAllocator::send_allowed(int inport, int invc, int outport, int outvc)
     // Check if outvc needed
     // Check if credit needed (for multi-flit packet)
     // Check if ordering violated (in ordered vnet)
-    assert(outvc == -1);
     int vnet = get_vnet(invc);
     bool has_outvc = (outvc != -1);
     bool has_credit = false;
@@ -404,8 +468,8 @@ SwitchAllocator::vc_allocate(int outport, int inport, int invc)
 
     // has to get a valid VC since it checked before performing SA
     assert(outvc != -1);
-    // for single flit packet we don't need to grant_outvc()
-    // m_input_unit[inport]->grant_outvc(invc, outvc);
+    // BODY/TAIL flits of this packet will use the same outvc
+    m_input_unit[inport]->grant_outvc(invc, outvc);
     // put it in the flit as well
     return outvc;
 }
@@ -418,7 +482,10 @@ SwitchAllocator::check_for_wakeup()
     Cycles nextCycle = m_router->curCycle() + Cycles(1);
 
     for (int i = 0; i < m_num_inports; i++) {
-        for (int j = 0; j < m_num_vcs; j++) {
+        uint64_t active_vcs = m_input_unit[i]->get_active_vcs();
+        while (active_vcs) {
+            int j = findLsbSet(active_vcs);
+            active_vcs &= active_vcs - 1;
             if (m_input_unit[i]->need_stage(j, SA_, nextCycle)) {
                 m_router->schedule_wakeup(Cycles(1));
                 return;
@@ -441,6 +508,11 @@ SwitchAllocator::get_vnet(int invc)
 void
 SwitchAllocator::clear_request_vector()
 {
+    if (m_bitmask_alloc) {
+        std::fill(m_port_request_mask.begin(), m_port_request_mask.end(), 0);
+        return;
+    }
+
     for (int i = 0; i < m_num_outports; i++) {
         for (int j = 0; j < m_num_inports; j++) {
             m_port_requests[i][j] = false;
@@ -454,3 +526,32 @@ SwitchAllocator::resetStats()
     m_input_arbiter_activity = 0;
     m_output_arbiter_activity = 0;
 }
+
+void
+SwitchAllocator::resetState()
+{
+    std::fill(m_round_robin_invc.begin(), m_round_robin_invc.end(), 0);
+    std::fill(m_round_robin_inport.begin(), m_round_robin_inport.end(), 0);
+    clear_request_vector();
+}
+
+void
+SwitchAllocator::serialize(CheckpointOut &cp) const
+{
+    SERIALIZE_CONTAINER(m_round_robin_invc);
+    SERIALIZE_CONTAINER(m_round_robin_inport);
+}
+
+void
+SwitchAllocator::unserialize(CheckpointIn &cp)
+{
+    vector<int> round_robin_invc, round_robin_inport;
+    arrayParamIn(cp, "m_round_robin_invc", round_robin_invc);
+    arrayParamIn(cp, "m_round_robin_inport", round_robin_inport);
+    fatal_if(round_robin_invc.size() != m_round_robin_invc.size() ||
+             round_robin_inport.size() != m_round_robin_inport.size(),
+             "Checkpointed router %d has a different number of ports\n",
+             m_router->get_id());
+    m_round_robin_invc = round_robin_invc;
+    m_round_robin_inport = round_robin_inport;
+}
@@ -39,12 +39,13 @@
 
 #include "mem/ruby/common/Consumer.hh"
 #include "mem/ruby/network/garnet2.0/CommonTypes.hh"
+#include "sim/serialize.hh"
 
 class Router;
 class InputUnit;
 class OutputUnit;
 
-class SwitchAllocator : public Consumer
+class SwitchAllocator : public Consumer, public Serializable
 {
   public:
     SwitchAllocator(Router *router);
@@ -56,6 +57,8 @@ class SwitchAllocator : public Consumer
     void print(std::ostream& out) const {};
     void arbitrate_inports();
     void arbitrate_outports();
+    void arbitrate_outports_bitmask();
+    void grant_outport(int outport, int inport);
     bool send_allowed(int inport, int invc, int outport, int outvc);
     int vc_allocate(int outport, int inport, int invc);
 
@@ -81,6 +84,12 @@ class SwitchAllocator : public Consumer
     }
 
     void resetStats();
+    // round-robin pointers back to port and vc 0
+    void resetState();
+
+    // round-robin pointers; requests only live within a cycle
+    void serialize(CheckpointOut &cp) const override;
+    void unserialize(CheckpointIn &cp) override;
 
   private:
     int m_num_inports, m_num_outports;
@@ -92,6 +101,9 @@ class SwitchAllocator : public Consumer
     std::vector<int> m_round_robin_invc;
     std::vector<int> m_round_robin_inport;
     std::vector<std::vector<bool>> m_port_requests;
+    // bitmask allocator: one bit per requesting inport, per outport
+    bool m_bitmask_alloc;
+    std::vector<uint64_t> m_port_request_mask;
     std::vector<std::vector<int>> m_vc_winners; // a list for each outport
     std::vector<InputUnit *> m_input_unit;
     std::vector<OutputUnit *> m_output_unit;
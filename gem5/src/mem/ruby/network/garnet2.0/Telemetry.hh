@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET_TELEMETRY_HH__
+#define __MEM_RUBY_NETWORK_GARNET_TELEMETRY_HH__
+
+#include <cstdint>
+
+// Records of the periodic telemetry file written by GarnetNetwork when
+// telemetry_period is non-zero (read by util/garnet_telemetry.py).
+// All fields are little-endian and the structs have no padding.
+//
+// File layout:
+//   TelemetryHeader
+//   TelemetryLinkInfo        x num_links
+//   then per epoch:
+//     TelemetryRouterRecord  x num_routers
+//     TelemetryLinkRecord    x num_links
+//
+// Counts in the records are for the epoch that ends at 'cycle';
+// occupancy is the number of flits buffered at that cycle.
+
+#define GARNET_TELEMETRY_MAGIC "GNTELEM"
+#define GARNET_TELEMETRY_VERSION 1
+
+struct TelemetryHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t period;
+    uint32_t num_routers;
+    uint32_t num_links;
+};
+
+// router at each end of a link; -1 is an NI
+struct TelemetryLinkInfo
+{
+    int32_t src_router;
+    int32_t dest_router;
+    uint32_t type; // link_type
+};
+
+struct TelemetryRouterRecord
+{
+    uint64_t cycle;
+    uint32_t router;
+    uint32_t occupancy;
+    uint32_t swaps_initiated;
+    uint32_t swaps_done;
+    uint32_t swaps_failed;
+    uint32_t bail_outs;
+};
+
+struct TelemetryLinkRecord
+{
+    uint64_t cycle;
+    uint32_t link;
+    uint32_t flits;
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET_TELEMETRY_HH__
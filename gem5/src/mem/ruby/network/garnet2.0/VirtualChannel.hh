@@ -56,6 +56,7 @@ class VirtualChannel
     inline Cycles get_enqueue_time()          { return m_enqueue_time; }
     inline void set_enqueue_time(Cycles time) { m_enqueue_time = time; }
     inline VC_state_type get_state()        { return m_vc_state.first; }
+    inline Cycles get_state_time()          { return m_vc_state.second; }
     inline bool isEmpty()                   { return m_input_buffer->isEmpty(); }
 
     inline bool isReady(Cycles curTime)
@@ -94,6 +95,10 @@ class VirtualChannel
         return m_input_buffer->getTopFlit();
     }
 
+    inline int getSize()                    { return m_input_buffer->getSize(); }
+    inline flit* peekFlit(int i)            { return m_input_buffer->flitAt(i); }
+    flitBuffer* getBuffer()                 { return m_input_buffer; }
+
     uint32_t functionalWrite(Packet *pkt);
 
   private:
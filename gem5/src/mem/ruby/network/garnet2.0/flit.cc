@@ -34,7 +34,7 @@
 #include "mem/ruby/network/garnet2.0/flit.hh"
 
 // Constructor for the flit
-flit::flit(int id, int  vc, int vnet, RouteInfo route, int size,
+flit::flit(int id, int  vc, int vnet, const RouteInfo &route, int size,
     MsgPtr msg_ptr, Cycles curTime)
 {
     m_size = size;
@@ -46,10 +46,13 @@ flit::flit(int id, int  vc, int vnet, RouteInfo route, int size,
     m_vnet = vnet;
     m_vc = vc; // which vc is this? cur or out?
     m_outvc = -1;
+    m_outport_dir = PortDirection_Unknown;
     m_route = route;
     m_stage.first = I_;
     m_stage.second = m_time;
     routedSwap = false;
+    m_measured = true;
+    m_packet_id = 0;
 
     if (size == 1) {
         m_type = HEAD_TAIL_;
@@ -86,8 +89,9 @@ flit::print(std::ostream& out) const
 bool
 flit::functionalWrite(Packet *pkt)
 {
+    // credits, and flits restored from a checkpoint, carry no message
     Message *msg = m_msg_ptr.get();
-    return msg->functionalWrite(pkt);
+    return msg && msg->functionalWrite(pkt);
 }
 
 void
@@ -103,3 +107,58 @@ flit::get_outport_dir()
 	return m_outport_dir;
 }
 
+void
+flit::serialize(std::vector<uint64_t> &words) const
+{
+    words.push_back(m_id);
+    words.push_back(m_vnet);
+    words.push_back(m_vc);
+    words.push_back(m_outvc);
+    words.push_back(routedSwap);
+    words.push_back(m_route.vnet);
+    words.push_back(m_route.src_ni);
+    words.push_back(m_route.src_router);
+    words.push_back(m_route.dest_ni);
+    words.push_back(m_route.dest_router);
+    words.push_back(m_route.hops_traversed);
+    words.push_back(m_size);
+    words.push_back(m_enqueue_time);
+    words.push_back(m_dequeue_time);
+    words.push_back(m_time);
+    words.push_back(m_type);
+    words.push_back(m_outport);
+    words.push_back(m_outport_dir);
+    words.push_back(src_delay);
+    words.push_back(m_measured);
+    words.push_back(m_packet_id);
+    words.push_back(m_stage.first);
+    words.push_back(m_stage.second);
+}
+
+void
+flit::unserialize(const std::vector<uint64_t> &words, size_t &pos)
+{
+    m_id = words.at(pos++);
+    m_vnet = words.at(pos++);
+    m_vc = words.at(pos++);
+    m_outvc = words.at(pos++);
+    routedSwap = words.at(pos++);
+    m_route.vnet = words.at(pos++);
+    m_route.src_ni = words.at(pos++);
+    m_route.src_router = words.at(pos++);
+    m_route.dest_ni = words.at(pos++);
+    m_route.dest_router = words.at(pos++);
+    m_route.hops_traversed = words.at(pos++);
+    m_size = words.at(pos++);
+    m_enqueue_time = Cycles(words.at(pos++));
+    m_dequeue_time = Cycles(words.at(pos++));
+    m_time = Cycles(words.at(pos++));
+    m_type = (flit_type) words.at(pos++);
+    m_outport = words.at(pos++);
+    m_outport_dir = (PortDirection) words.at(pos++);
+    src_delay = Cycles(words.at(pos++));
+    m_measured = words.at(pos++);
+    m_packet_id = words.at(pos++);
+    m_stage.first = (flit_stage) words.at(pos++);
+    m_stage.second = Cycles(words.at(pos++));
+}
@@ -36,18 +36,18 @@
 
 #include <cassert>
 #include <iostream>
+#include <vector>
 
 #include "base/types.hh"
+#include "mem/protocol/PortDirection.hh"
 #include "mem/ruby/network/garnet2.0/CommonTypes.hh"
 #include "mem/ruby/slicc_interface/Message.hh"
 
-typedef std::string PortDirection;
-
 class flit
 {
   public:
     flit() {}
-    flit(int id, int vc, int vnet, RouteInfo route, int size,
+    flit(int id, int vc, int vnet, const RouteInfo &route, int size,
          MsgPtr msg_ptr, Cycles curTime);
 
     int get_outport() {return m_outport; }
@@ -63,19 +63,23 @@ class flit
     int get_vnet() { return m_vnet; }
     int get_vc() { return m_vc; }
     // int get_outvc() { return m_outvc; }
-    RouteInfo get_route() { return m_route; }
+    const RouteInfo &get_route() const { return m_route; }
     MsgPtr& get_msg_ptr() { return m_msg_ptr; }
     flit_type get_type() { return m_type; }
     std::pair<flit_stage, Cycles> get_stage() { return m_stage; }
     Cycles get_src_delay() { return src_delay; }
+    bool is_measured() { return m_measured; }
+    uint64_t get_packet_id() { return m_packet_id; }
 
     void set_outport(int port) { m_outport = port; }
 	void set_outport_dir(PortDirection dir);
     void set_time(Cycles time) { m_time = time; }
     void set_vc(int vc) { m_vc = vc; }
     // void set_outvc(int vc) {    m_outvc = vc; }
-    void set_route(RouteInfo route) { m_route = route; }
+    void set_route(const RouteInfo &route) { m_route = route; }
     void set_src_delay(Cycles delay) { src_delay = delay; }
+    void set_measured(bool measured) { m_measured = measured; }
+    void set_packet_id(uint64_t id) { m_packet_id = id; }
     void set_dequeue_time(Cycles time) { m_dequeue_time = time; }
 
     void increment_hops() { m_route.hops_traversed++; }
@@ -108,6 +112,12 @@ class flit
 
     bool functionalWrite(Packet *pkt);
 
+    // Checkpointing: append the flit's state to 'words', or read it
+    // back starting at 'pos' (which is advanced past it). The protocol
+    // message is not saved; a restored flit has an empty m_msg_ptr.
+    void serialize(std::vector<uint64_t> &words) const;
+    void unserialize(const std::vector<uint64_t> &words, size_t &pos);
+
   public:
 //    protected:
     int m_id;
@@ -123,6 +133,10 @@ class flit
     int m_outport;
 	PortDirection m_outport_dir;
     Cycles src_delay;
+    // injected inside the measurement window (see GarnetNetwork)
+    bool m_measured;
+    // network-wide packet number, for the flit trace
+    uint64_t m_packet_id;
     std::pair<flit_stage, Cycles> m_stage;
 };
 
@@ -33,27 +33,54 @@
 
 #include "mem/ruby/network/garnet2.0/flitBuffer.hh"
 
+// Initial capacity of a circular flitBuffer; it doubles when full.
+#define FLIT_BUFFER_INIT_CAPACITY 4
+
 flitBuffer::flitBuffer()
+    : m_buffer(FLIT_BUFFER_INIT_CAPACITY), m_head(0),
+      m_mask(FLIT_BUFFER_INIT_CAPACITY - 1), m_size(0),
+      max_size(INFINITE_), m_time_ordered(false)
+{
+}
+
+flitBuffer::flitBuffer(int maximum_size, bool time_ordered)
+    : m_head(0), m_mask(0), m_size(0), max_size(maximum_size),
+      m_time_ordered(time_ordered)
 {
-    max_size = INFINITE_;
+    if (!m_time_ordered) {
+        m_buffer.resize(FLIT_BUFFER_INIT_CAPACITY);
+        m_mask = FLIT_BUFFER_INIT_CAPACITY - 1;
+    }
 }
 
-flitBuffer::flitBuffer(int maximum_size)
+// Double the capacity of a full circular buffer, unrolling it so
+// that the oldest flit ends up at index 0.
+void
+flitBuffer::grow()
 {
-    max_size = maximum_size;
+    assert(!m_time_ordered);
+    assert(m_size == m_buffer.size());
+
+    std::vector<flit *> new_buffer(2 * m_buffer.size());
+    for (int i = 0; i < m_size; i++) {
+        new_buffer[i] = flitAt(i);
+    }
+    m_buffer.swap(new_buffer);
+    m_head = 0;
+    m_mask = m_buffer.size() - 1;
 }
 
 bool
 flitBuffer::isEmpty()
 {
-//    cout <<"BufferSize: " << m_buffer.size() << endl;
-    return (m_buffer.size() == 0);
+//    cout <<"BufferSize: " << m_size << endl;
+    return (m_size == 0);
 }
 
 bool
 flitBuffer::isReady(Cycles curTime)
 {
-    if (m_buffer.size() != 0 ) {
+    if (m_size != 0 ) {
         flit *t_flit = peekTopFlit();
         if (t_flit->get_time() <= curTime)
             return true;
@@ -64,13 +91,13 @@ flitBuffer::isReady(Cycles curTime)
 void
 flitBuffer::print(std::ostream& out) const
 {
-    out << "[flitBuffer: " << m_buffer.size() << "] " << std::endl;
+    out << "[flitBuffer: " << m_size << "] " << std::endl;
 }
 
 bool
 flitBuffer::isFull()
 {
-    return (m_buffer.size() >= max_size);
+    return (m_size >= max_size);
 }
 
 void
@@ -84,8 +111,8 @@ flitBuffer::functionalWrite(Packet *pkt)
 {
     uint32_t num_functional_writes = 0;
 
-    for (unsigned int i = 0; i < m_buffer.size(); ++i) {
-        if (m_buffer[i]->functionalWrite(pkt)) {
+    for (int i = 0; i < m_size; ++i) {
+        if (flitAt(i)->functionalWrite(pkt)) {
             num_functional_writes++;
         }
     }
@@ -40,27 +40,41 @@
 
 #include "mem/ruby/network/garnet2.0/CommonTypes.hh"
 #include "mem/ruby/network/garnet2.0/flit.hh"
+#include "mem/ruby/network/garnet2.0/flitPool.hh"
 
 using namespace std;
+
+// flitBuffer is a FIFO by default, kept in a circular buffer: all
+// link, VC, credit and NI queues see flits in non-decreasing time order
+// by construction, and SWAP only ever puts a flit back at the head.
+// A time-ordered flitBuffer keeps the old binary heap (by flit::greater)
+// for the few queues where flits can be inserted out of time order.
 class flitBuffer
 {
   public:
     flitBuffer();
-    flitBuffer(int maximum_size);
+    flitBuffer(int maximum_size, bool time_ordered = false);
 
     bool isReady(Cycles curTime);
     bool isEmpty();
     void print(std::ostream& out) const;
     bool isFull();
     void setMaxSize(int maximum);
-    int getSize() const { return m_buffer.size(); }
+    int getSize() const { return m_size; }
 
     flit *
     getTopFlit()
     {
-        flit *f = m_buffer.front();
-        std::pop_heap(m_buffer.begin(), m_buffer.end(), flit::greater);
-        m_buffer.pop_back();
+        flit *f;
+        if (m_time_ordered) {
+            f = m_buffer.front();
+            std::pop_heap(m_buffer.begin(), m_buffer.end(), flit::greater);
+            m_buffer.pop_back();
+        } else {
+            f = m_buffer[m_head];
+            m_head = (m_head + 1) & m_mask;
+        }
+        m_size--;
         return f;
     }
 
@@ -70,37 +84,76 @@ class flitBuffer
         // making the safety check here
         // because front() on empty container
         // causes undefined behavior.
-        assert(m_buffer.size() > 0);
-        return m_buffer.front();
+        assert(m_size > 0);
+        return m_buffer[m_head];
+    }
+
+    // i-th flit in storage order (FIFO order for a circular buffer)
+    flit *
+    flitAt(int i) const
+    {
+        return m_time_ordered ? m_buffer[i] : m_buffer[(m_head + i) & m_mask];
     }
 
     void
     insert(flit *flt)
     {
-        m_buffer.push_back(flt);
-        std::push_heap(m_buffer.begin(), m_buffer.end(), flit::greater);
+        if (m_time_ordered) {
+            m_buffer.push_back(flt);
+            std::push_heap(m_buffer.begin(), m_buffer.end(), flit::greater);
+        } else {
+            if (m_size == m_buffer.size())
+                grow();
+            m_buffer[(m_head + m_size) & m_mask] = flt;
+        }
+        m_size++;
     }
 
     void
     insertAtTop(flit *flt)
     {
-        m_buffer.insert(m_buffer.begin(), flt);
+        if (m_time_ordered) {
+            m_buffer.insert(m_buffer.begin(), flt);
+        } else {
+            if (m_size == m_buffer.size())
+                grow();
+            m_head = (m_head - 1) & m_mask;
+            m_buffer[m_head] = flt;
+        }
+        m_size++;
     }
 
     void
     scan()
     {
-        for (std::vector<flit *>::iterator itr = m_buffer.begin(); itr != m_buffer.end(); ++itr)
-        {
-            cout << **itr << endl;
+        for (int i = 0; i < m_size; i++) {
+            cout << *flitAt(i) << endl;
         }
     }
 
     uint32_t functionalWrite(Packet *pkt);
 
+    // drop every buffered flit, handing it back to 'pool'
+    template <class T>
+    void
+    clear(flitPool<T> &pool)
+    {
+        while (m_size > 0)
+            pool.release(static_cast<T *>(getTopFlit()));
+    }
+
   private:
+    void grow();
+
+    // Circular buffer: capacity is m_buffer.size(), always a power of
+    // two, and m_head indexes the oldest flit.
+    // Time-ordered: m_buffer is a heap of m_size flits; m_head stays 0.
     std::vector<flit *> m_buffer;
+    unsigned int m_head;
+    unsigned int m_mask;
+    int m_size;
     int max_size;
+    bool m_time_ordered;
 };
 
 inline std::ostream&
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET_FLIT_POOL_HH__
+#define __MEM_RUBY_NETWORK_GARNET_FLIT_POOL_HH__
+
+#include <cassert>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Slab allocator with a free list for flits and credits.
+// Storage is carved out of chunks of m_chunk_size objects and recycled
+// on release(), so the steady state does no malloc/free per packet or
+// per hop. One pool of each type is owned by the GarnetNetwork and
+// shared by all NIs and routers; setThreadSafe() makes it take a lock
+// when the network is partitioned across threads.
+
+template <class T>
+class flitPool
+{
+  public:
+    flitPool(int chunk_size = 256)
+        : m_chunk_size(chunk_size), m_in_use(0), m_high_water_mark(0),
+          m_thread_safe(false)
+    {}
+
+    ~flitPool()
+    {
+        for (auto chunk : m_chunks)
+            ::operator delete(chunk);
+    }
+
+    template <typename... Args>
+    T *
+    allocate(Args&&... args)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex, std::defer_lock);
+        if (m_thread_safe)
+            lock.lock();
+
+        if (m_free_list.empty())
+            grow();
+
+        T *obj = m_free_list.back();
+        m_free_list.pop_back();
+
+        m_in_use++;
+        if (m_in_use > m_high_water_mark)
+            m_high_water_mark = m_in_use;
+
+        return new (obj) T(std::forward<Args>(args)...);
+    }
+
+    void
+    release(T *obj)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex, std::defer_lock);
+        if (m_thread_safe)
+            lock.lock();
+
+        assert(m_in_use > 0);
+        obj->~T();
+        m_free_list.push_back(obj);
+        m_in_use--;
+    }
+
+    int getInUse() const { return m_in_use; }
+    int getHighWaterMark() const { return m_high_water_mark; }
+    void setThreadSafe(bool thread_safe) { m_thread_safe = thread_safe; }
+
+  private:
+    flitPool(const flitPool& obj);
+    flitPool& operator=(const flitPool& obj);
+
+    void
+    grow()
+    {
+        T *chunk = static_cast<T *>(::operator new(m_chunk_size * sizeof(T)));
+        m_chunks.push_back(chunk);
+        // push in reverse so that objects are handed out in address order
+        for (int i = m_chunk_size - 1; i >= 0; i--)
+            m_free_list.push_back(chunk + i);
+    }
+
+    int m_chunk_size;
+    int m_in_use;
+    int m_high_water_mark;
+    bool m_thread_safe;
+    std::mutex m_mutex;
+    std::vector<T *> m_chunks;
+    std::vector<T *> m_free_list;
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET_FLIT_POOL_HH__
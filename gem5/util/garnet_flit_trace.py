@@ -0,0 +1,160 @@
+#!/usr/bin/env python
+# Copyright (c) 2026 agent
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+# Converts the flit trace garnet2.0 writes with --garnet-flit-trace
+# (format in src/mem/ruby/network/garnet2.0/FlitTrace.hh) to Chrome
+# trace / Perfetto JSON (open in chrome://tracing or ui.perfetto.dev).
+#
+# Every router and NI is a process and every port a thread; each
+# record becomes an instant event on it. Each packet is also an async
+# span from its first injected flit to its last ejected flit.
+
+from __future__ import print_function
+
+import argparse
+import json
+import struct
+import sys
+
+MAGIC = b"GNFTRACE"
+VERSION = 1
+
+HEADER = struct.Struct("<8sIIQ")
+RECORD = struct.Struct("<QQhBBHH")
+
+EVENTS = ["inject", "LT", "RC", "SA", "ST", "swap_out", "swap_in",
+          "bail_out", "eject"]
+NI_EVENTS = ("inject", "eject")
+
+# NIs, routers and the packet spans share the pid space
+NI_PID_BASE = 1 << 16
+PACKET_PID = 1 << 17
+
+def read_records(f):
+    magic, version, record_size, ticks_per_second = \
+        HEADER.unpack(f.read(HEADER.size))
+    if magic != MAGIC:
+        raise ValueError("not a garnet flit trace")
+    if version != VERSION or record_size != RECORD.size:
+        raise ValueError("unsupported flit trace version %d" % version)
+
+    def records():
+        while True:
+            data = f.read(RECORD.size * 4096)
+            if not data:
+                return
+            # drop a partial record at the end of a truncated file
+            data = data[:len(data) - len(data) % RECORD.size]
+            for rec in RECORD.iter_unpack(data) \
+                    if hasattr(RECORD, "iter_unpack") else \
+                    (RECORD.unpack_from(data, i)
+                     for i in range(0, len(data), RECORD.size)):
+                yield rec
+
+    return ticks_per_second, records()
+
+def convert(in_file, out, packets_only, limit):
+    ticks_per_second, records = read_records(in_file)
+    to_us = 1e6 / ticks_per_second
+
+    first_inject = {}
+    last_eject = {}
+    pids = set()
+
+    out.write('{"displayTimeUnit": "ns", "traceEvents": [\n')
+    sep = ""
+    for n, (tick, packet, location, event, port, vc, flit) in \
+            enumerate(records):
+        if limit and n >= limit:
+            break
+        name = EVENTS[event] if event < len(EVENTS) else str(event)
+        ts = tick * to_us
+
+        if name == "inject":
+            first_inject.setdefault(packet, ts)
+        elif name == "eject":
+            last_eject[packet] = ts
+
+        if packets_only:
+            continue
+
+        is_ni = name in NI_EVENTS
+        pid = NI_PID_BASE + location if is_ni else location
+        pids.add((pid, is_ni, location))
+        out.write(sep + json.dumps({
+            "name": name, "ph": "i", "s": "t", "ts": ts,
+            "pid": pid, "tid": -1 if port == 0xff else port,
+            "args": {"packet": packet, "flit": flit, "vc": vc}}))
+        sep = ",\n"
+
+    spans = False
+    for packet, start in first_inject.items():
+        if packet not in last_eject:
+            continue
+        spans = True
+        for ph, ts in (("b", start), ("e", last_eject[packet])):
+            out.write(sep + json.dumps({
+                "name": "packet %d" % packet, "cat": "packet", "ph": ph,
+                "id": packet, "ts": ts, "pid": PACKET_PID, "tid": 0}))
+            sep = ",\n"
+    if spans:
+        out.write(sep + json.dumps({
+            "name": "process_name", "ph": "M", "pid": PACKET_PID,
+            "args": {"name": "packets"}}))
+        sep = ",\n"
+
+    for pid, is_ni, location in sorted(pids):
+        out.write(sep + json.dumps({
+            "name": "process_name", "ph": "M", "pid": pid,
+            "args": {"name": ("NI %d" if is_ni else "router %d")
+                     % location}}))
+        sep = ",\n"
+
+    out.write("\n]}\n")
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Convert a garnet2.0 flit trace to Chrome trace JSON")
+    parser.add_argument("trace", help="garnet_flit_trace.bin")
+    parser.add_argument("-o", "--output", default="-",
+                        help="output JSON file (default: stdout)")
+    parser.add_argument("--packets-only", action="store_true",
+                        help="only emit the per-packet spans")
+    parser.add_argument("--limit", type=int, default=0,
+                        help="stop after this many records")
+    args = parser.parse_args()
+
+    with open(args.trace, "rb") as f:
+        if args.output == "-":
+            convert(f, sys.stdout, args.packets_only, args.limit)
+        else:
+            with open(args.output, "w") as out:
+                convert(f, out, args.packets_only, args.limit)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,183 @@
+#!/usr/bin/env python
+# Copyright (c) 2026 agent
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Reader for the telemetry file garnet2.0 writes with
+# --garnet-telemetry-period (format in
+# src/mem/ruby/network/garnet2.0/Telemetry.hh).
+#
+# As a module:
+#   t = read_telemetry('m5out/garnet_telemetry.bin')
+#   t.routers  -> list of epochs, each a list of RouterRecord
+#   t.links    -> list of epochs, each a list of LinkRecord
+#   t.link_info[i] -> LinkInfo of link i
+#
+# From the command line it prints either a summary of the hottest
+# routers/links, or one CSV line per record (--csv routers|links).
+
+from __future__ import print_function
+
+import argparse
+import collections
+import struct
+import sys
+
+MAGIC = b"GNTELEM\0"
+VERSION = 1
+
+HEADER = struct.Struct("<8sIIII")
+LINK_INFO = struct.Struct("<iiI")
+ROUTER_RECORD = struct.Struct("<QIIIIII")
+LINK_RECORD = struct.Struct("<QII")
+
+LINK_TYPES = ["ext_in", "ext_out", "int"]
+
+LinkInfo = collections.namedtuple("LinkInfo",
+                                  "src_router dest_router type")
+RouterRecord = collections.namedtuple("RouterRecord",
+    "cycle router occupancy swaps_initiated swaps_done swaps_failed "
+    "bail_outs")
+LinkRecord = collections.namedtuple("LinkRecord", "cycle link flits")
+
+class Telemetry(object):
+    def __init__(self, period, link_info):
+        self.period = period
+        self.link_info = link_info
+        self.routers = []
+        self.links = []
+
+def read_telemetry(path):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    magic, version, period, num_routers, num_links = \
+        HEADER.unpack_from(data, 0)
+    if magic != MAGIC:
+        raise ValueError("%s is not a garnet telemetry file" % path)
+    if version != VERSION:
+        raise ValueError("unsupported telemetry version %d" % version)
+
+    offset = HEADER.size
+    link_info = []
+    for i in range(num_links):
+        src, dest, type_ = LINK_INFO.unpack_from(data, offset)
+        link_info.append(LinkInfo(src, dest, LINK_TYPES[type_]))
+        offset += LINK_INFO.size
+
+    t = Telemetry(period, link_info)
+    epoch_size = num_routers * ROUTER_RECORD.size + \
+                 num_links * LINK_RECORD.size
+    # a run that was cut short may leave a partial last epoch
+    while offset + epoch_size <= len(data):
+        routers = []
+        for i in range(num_routers):
+            routers.append(RouterRecord(
+                *ROUTER_RECORD.unpack_from(data, offset)))
+            offset += ROUTER_RECORD.size
+        links = []
+        for i in range(num_links):
+            links.append(LinkRecord(*LINK_RECORD.unpack_from(data, offset)))
+            offset += LINK_RECORD.size
+        t.routers.append(routers)
+        t.links.append(links)
+    return t
+
+def print_csv(t, what):
+    if what == "routers":
+        print(",".join(RouterRecord._fields))
+        for epoch in t.routers:
+            for r in epoch:
+                print(",".join(str(v) for v in r))
+    else:
+        print(",".join(LinkRecord._fields + LinkInfo._fields))
+        for epoch in t.links:
+            for l in epoch:
+                print(",".join(str(v) for v in l + t.link_info[l.link]))
+
+def print_summary(t, top):
+    print("epochs: %d  period: %d cycles  routers: %d  links: %d" %
+          (len(t.routers), t.period,
+           len(t.routers[0]) if t.routers else 0, len(t.link_info)))
+    if not t.routers:
+        return
+
+    occupancy = collections.Counter()
+    peak = collections.Counter()
+    swaps = collections.Counter()
+    failed = collections.Counter()
+    bail_outs = collections.Counter()
+    for epoch in t.routers:
+        for r in epoch:
+            occupancy[r.router] += r.occupancy
+            peak[r.router] = max(peak[r.router], r.occupancy)
+            swaps[r.router] += r.swaps_done
+            failed[r.router] += r.swaps_failed
+            bail_outs[r.router] += r.bail_outs
+
+    print("\nrouter  avg_occupancy  peak  swaps  failed  bail_outs")
+    for router, total in occupancy.most_common(top):
+        print("%6d  %13.2f  %4d  %5d  %6d  %9d" %
+              (router, float(total) / len(t.routers), peak[router],
+               swaps[router], failed[router], bail_outs[router]))
+
+    flits = collections.Counter()
+    for epoch in t.links:
+        for l in epoch:
+            flits[l.link] += l.flits
+
+    cycles = float(len(t.links) * t.period)
+    print("\nlink  src  dest  type     utilization")
+    for link, total in flits.most_common(top):
+        info = t.link_info[link]
+        print("%4d  %3d  %4d  %-7s  %11.3f" %
+              (link, info.src_router, info.dest_router, info.type,
+               total / cycles))
+
+    # epochs with the most swap activity, to spot swap storms
+    storms = sorted(((sum(r.swaps_initiated for r in epoch), epoch[0].cycle)
+                     for epoch in t.routers), reverse=True)[:top]
+    print("\ncycle  swaps_initiated")
+    for count, cycle in storms:
+        print("%d  %d" % (cycle, count))
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Read a garnet2.0 telemetry file")
+    parser.add_argument("file", help="garnet_telemetry.bin")
+    parser.add_argument("--csv", choices=["routers", "links"],
+                        help="dump the records as CSV")
+    parser.add_argument("--top", type=int, default=10,
+                        help="rows per table in the summary")
+    args = parser.parse_args()
+
+    t = read_telemetry(args.file)
+    if args.csv:
+        print_csv(t, args.csv)
+    else:
+        print_summary(t, args.top)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,133 @@
+#!/usr/bin/env python
+# Copyright (c) 2026 agent
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Build the injection trace GarnetSyntheticTraffic replays with
+--trace-file (see src/cpu/testers/garnet_synthetic_traffic/
+InjectionTrace.hh).
+
+The input is text, one message per line:
+  cycle src dst vnet size
+Blank lines and lines starting with '#' are skipped.
+
+The packed trace is little-endian:
+  header          magic "GNINJTR\\0", u32 version, u32 num_nodes,
+                  u64 num_records
+  index           u64 x (num_nodes + 1); the records of node n are
+                  [index[n], index[n + 1])
+  records         u64 cycle, u32 src, u32 dst, u32 vnet, u32 size
+Records are grouped by source node and sorted by cycle; messages of
+one node at the same cycle keep their input order.
+
+With --dump it prints a packed trace back as text instead.
+"""
+
+from __future__ import print_function
+
+import argparse
+import struct
+import sys
+
+MAGIC = b"GNINJTR\0"
+VERSION = 1
+
+HEADER = struct.Struct("<8sIIQ")
+INDEX = struct.Struct("<Q")
+RECORD = struct.Struct("<QIIII")
+
+def read_text(f):
+    records = []
+    for lineno, line in enumerate(f, 1):
+        line = line.strip()
+        if not line or line.startswith("#"):
+            continue
+        fields = line.split()
+        if len(fields) != 5:
+            sys.exit("line %d: expected 'cycle src dst vnet size'" % lineno)
+        try:
+            records.append(tuple(int(x) for x in fields))
+        except ValueError:
+            sys.exit("line %d: fields must be integers" % lineno)
+    return records
+
+def pack(records, num_nodes, out):
+    if num_nodes is None:
+        num_nodes = max([max(r[1], r[2]) for r in records] + [-1]) + 1
+    for r in records:
+        if r[1] >= num_nodes or r[2] >= num_nodes:
+            sys.exit("record %s names a node >= %d" % (r, num_nodes))
+    records.sort(key=lambda r: (r[1], r[0]))
+
+    first = [0] * (num_nodes + 1)
+    for r in records:
+        first[r[1] + 1] += 1
+    for n in range(num_nodes):
+        first[n + 1] += first[n]
+
+    out.write(HEADER.pack(MAGIC, VERSION, num_nodes, len(records)))
+    for idx in first:
+        out.write(INDEX.pack(idx))
+    for r in records:
+        out.write(RECORD.pack(*r))
+
+def dump(f):
+    magic, version, num_nodes, num_records = \
+        HEADER.unpack(f.read(HEADER.size))
+    if magic != MAGIC or version != VERSION:
+        sys.exit("not a version %d injection trace" % VERSION)
+    f.seek(INDEX.size * (num_nodes + 1), 1)
+    print("# cycle src dst vnet size")
+    for _ in range(num_records):
+        print("%d %d %d %d %d" % RECORD.unpack(f.read(RECORD.size)))
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="text trace, or packed with --dump")
+    parser.add_argument("output", nargs="?",
+                        help="packed trace to write")
+    parser.add_argument("--num-nodes", type=int, default=None,
+                        help="nodes in the simulated system; default is "
+                             "one more than the largest node in the trace")
+    parser.add_argument("--dump", action="store_true",
+                        help="print a packed trace as text")
+    args = parser.parse_args()
+
+    if args.dump:
+        with open(args.input, "rb") as f:
+            dump(f)
+        return
+
+    if args.output is None:
+        parser.error("output file required")
+    with open(args.input) as f:
+        records = read_text(f)
+    with open(args.output, "wb") as out:
+        pack(records, args.num_nodes, out)
+
+if __name__ == "__main__":
+    main()